@@ -0,0 +1,287 @@
+/**
+ * @file bench.c
+ * @brief Host benchmark of the flip dot driver and games on the simulated panel
+ *
+ * Runs every demo under every sweep mode and reports, per run:
+ *   flips/s   dots flipped per second of panel time (pulse plus recovery)
+ *   cpu/frame host CPU time spent per frame, driver, demo and sim together
+ *   worst     worst submit-to-done latency of a frame in virtual time, for
+ *             the snake demo this is the worst game tick
+ *   toggles   address line toggles per pulse
+ *   faults    misfires, stray pulses and address glitches seen by the panel
+ *   panel     whether the simulated dots match the driver's pixel state
+ *
+ * Usage: flip_dot_bench [-s] [-a] [-v supply_mv] [-e max_on_us] [-g idle_off_ms]
+ *   -s  fire pulses one at a time instead of pipelined
+ *   -a  adaptive pulse timing from the simulated supply
+ *   -v  supply voltage, 2200 mV by default
+ *   -e  coil-on energy budget per 100 ms window
+ *   -g  switch the simulated supply off after this long idle
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "flip_dot.h"
+#include "snake.h"
+#include "sim_panel.h"
+#include "sim_rtos.h"
+#include "esp_rom_sys.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    const char *name;
+    void (*run)(flip_dot_t *display);
+} bench_demo_t;
+
+// Same curve as the firmware, see main.c
+static const flip_dot_timing_point_t bench_timing_curve[] = {
+    { .supply_mv = 1800, .flip_time_us = 2800, .recovery_time_us = 1400 },
+    { .supply_mv = 2200, .flip_time_us = 2000, .recovery_time_us = 1000 },
+    { .supply_mv = 2600, .flip_time_us = 1500, .recovery_time_us = 800 },
+};
+
+static const char *sweep_mode_names[SWEEP_MODE_COUNT] = {
+    "row", "col", "diag", "random", "serpentine", "spiral", "fastest"
+};
+
+#define BENCH_ENERGY_WINDOW_US  100000
+#define BENCH_SUPPLY_RISE_US    5000    // Supply settle time after switching on
+
+typedef struct {
+    bool pipelined;
+    bool adaptive;
+    uint32_t energy_max_on_us;      // 0 for no energy budget
+    uint32_t supply_idle_off_ms;    // 0 for no supply gating
+} bench_options_t;
+
+static flip_dot_t s_display;
+static flip_dot_energy_budget_t s_energy_budget;
+static flip_dot_supply_gate_t s_supply_gate;
+static int s_supply_mv;
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static void run_sine_wave(flip_dot_t *display);
+static void run_bouncing_ball(flip_dot_t *display);
+static void run_matrix_rain(flip_dot_t *display);
+static void run_ripple_effect(flip_dot_t *display);
+static void run_scrolling_text(flip_dot_t *display);
+static void run_game_of_life(flip_dot_t *display);
+static void run_snake(flip_dot_t *display);
+static void run_transitions(flip_dot_t *display);
+static void run_budgeted(flip_dot_t *display);
+static bool panel_matches(const flip_dot_t *display);
+static esp_err_t bench_supply_on(void);
+static esp_err_t bench_supply_off(void);
+static void bench_run(sweep_mode_t mode, const bench_demo_t *demo, const bench_options_t *options,
+                      const sim_panel_config_t *config);
+
+static const bench_demo_t bench_demos[] = {
+    { "sine_wave", run_sine_wave },
+    { "bouncing_ball", run_bouncing_ball },
+    { "matrix_rain", run_matrix_rain },
+    { "ripple", run_ripple_effect },
+    { "scroll_text", run_scrolling_text },
+    { "game_of_life", run_game_of_life },
+    { "snake", run_snake },
+    { "transitions", run_transitions },
+    { "budgeted", run_budgeted },
+};
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static void run_sine_wave(flip_dot_t *display) {
+    flip_dot_demo_sine_wave(display, 50);
+}
+
+static void run_bouncing_ball(flip_dot_t *display) {
+    flip_dot_demo_bouncing_ball(display, 50);
+}
+
+static void run_matrix_rain(flip_dot_t *display) {
+    flip_dot_demo_matrix_rain(display, 50);
+}
+
+static void run_ripple_effect(flip_dot_t *display) {
+    flip_dot_demo_ripple_effect(display, 50);
+}
+
+static void run_scrolling_text(flip_dot_t *display) {
+    flip_dot_demo_scrolling_text(display, "Hello, flip dots! 0123456789", 100);
+}
+
+static void run_game_of_life(flip_dot_t *display) {
+    flip_dot_demo_game_of_life(display, 100, 100);
+}
+
+static void run_snake(flip_dot_t *display) {
+    snake_game_demo(display, 60000);
+}
+
+// Every effect between a checkerboard and a full panel, 1 s each. The worst
+// latency shows how close they keep to their duration.
+static void run_transitions(flip_dot_t *display) {
+    flip_dot_frame_t checker, full;
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        checker.rows[r] = ((r & 1) ? 0xAAAAAAAAUL : 0x55555555UL) & FLIP_DOT_ROW_MASK;
+        full.rows[r] = FLIP_DOT_ROW_MASK;
+    }
+    for (int effect = FLIP_DOT_TRANSITION_WIPE; effect < FLIP_DOT_TRANSITION_COUNT; effect++) {
+        flip_dot_transition(display, &checker, (flip_dot_transition_t)effect, 1000000);
+        flip_dot_transition(display, &full, (flip_dot_transition_t)effect, 1000000);
+    }
+}
+
+// Frames through the render path under a flip budget. The sim has a single
+// task, so the render path draws in the caller, through the same carry-over
+// loop as the render task. The deadline is shorter than one pulse plus
+// recovery, each slice must still make one flip.
+static void run_budgeted(flip_dot_t *display) {
+    flip_dot_set_flip_budget(display, 16, 0);
+    flip_dot_demo_scrolling_text(display, "Budget 16", 100);
+    flip_dot_set_flip_budget(display, 0, 1000);
+    flip_dot_demo_scrolling_text(display, "Deadline", 100);
+    flip_dot_set_flip_budget(display, 0, 0);
+}
+
+static bool panel_matches(const flip_dot_t *display) {
+    const flip_dot_frame_t *dots = sim_panel_get_frame();
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        if ((dots->rows[r] ^ display->pixel_state.rows[r]) & FLIP_DOT_ROW_MASK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t bench_supply_on(void) {
+    sim_panel_set_supply(s_supply_mv);
+    esp_rom_delay_us(BENCH_SUPPLY_RISE_US);
+    return ESP_OK;
+}
+
+static esp_err_t bench_supply_off(void) {
+    sim_panel_set_supply(0);
+    return ESP_OK;
+}
+
+static void bench_run(sweep_mode_t mode, const bench_demo_t *demo, const bench_options_t *options,
+                      const sim_panel_config_t *config) {
+    flip_dot_t *display = &s_display;
+
+    sim_rtos_reset();
+    sim_panel_init(config);
+    srand(1);
+
+    flip_dot_init(display, 2000, mode);
+    sim_panel_attach(display);
+    flip_dot_set_pipelined(display, options->pipelined);
+    // The reset dropped every timer, so the gate is built again for each run
+    if (options->supply_idle_off_ms) {
+        if (s_supply_gate.lock) {
+            vSemaphoreDelete(s_supply_gate.lock);
+        }
+        s_supply_mv = config->supply_mv;
+        flip_dot_supply_gate_init(&s_supply_gate, bench_supply_on, bench_supply_off,
+                                  options->supply_idle_off_ms, true);
+        flip_dot_set_supply_gate(display, &s_supply_gate);
+    }
+    if (options->energy_max_on_us) {
+        flip_dot_energy_budget_init(&s_energy_budget, options->energy_max_on_us, BENCH_ENERGY_WINDOW_US);
+        flip_dot_set_energy_budget(display, &s_energy_budget);
+    }
+    if (options->adaptive) {
+        flip_dot_enable_adaptive_timing(display, sim_panel_read_supply, bench_timing_curve,
+                                        sizeof(bench_timing_curve) / sizeof(bench_timing_curve[0]), 5000);
+    }
+    flip_dot_clear_display(display);
+
+    flip_dot_reset_stats(display);
+    sim_panel_reset_counters();
+    int64_t cpu_start_ns = sim_rtos_cpu_time_ns();
+
+    demo->run(display);
+
+    int64_t cpu_ns = sim_rtos_cpu_time_ns() - cpu_start_ns;
+    flip_dot_stats_t stats;
+    sim_panel_counters_t counters;
+    flip_dot_get_stats(display, &stats);
+    sim_panel_get_counters(&counters);
+
+    uint64_t panel_us = stats.pulse_us + stats.recovery_us;
+    uint32_t frames = stats.frames ? stats.frames : 1;
+    printf("%-11s %-14s %7lu %7lu %8.1f %10.1f %9.1f %8.2f %7lu  %s\n",
+           sweep_mode_names[mode], demo->name,
+           (unsigned long)stats.frames, (unsigned long)counters.flips,
+           panel_us ? counters.flips * 1e6 / panel_us : 0.0,
+           cpu_ns / 1000.0 / frames,
+           stats.max_latency_us / 1000.0,
+           counters.pulses ? (double)counters.line_toggles / counters.pulses : 0.0,
+           (unsigned long)(counters.misfires + counters.stray + counters.glitches),
+           panel_matches(display) ? "ok" : "MISMATCH");
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+int main(int argc, char **argv) {
+    bench_options_t options = { .pipelined = true };
+    sim_panel_config_t config = sim_panel_get_default_config();
+
+    int opt;
+    while ((opt = getopt(argc, argv, "sav:e:g:h")) != -1) {
+        switch (opt) {
+        case 's':
+            options.pipelined = false;
+            break;
+        case 'a':
+            options.adaptive = true;
+            break;
+        case 'v':
+            config.supply_mv = atoi(optarg);
+            break;
+        case 'e':
+            options.energy_max_on_us = atoi(optarg);
+            break;
+        case 'g':
+            options.supply_idle_off_ms = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-s] [-a] [-v supply_mv] [-e max_on_us] [-g idle_off_ms]\n", argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    printf("Supply %d mV, %s pulses, %s timing\n", config.supply_mv,
+           options.pipelined ? "pipelined" : "serial", options.adaptive ? "adaptive" : "fixed");
+    if (options.energy_max_on_us) {
+        printf("Energy budget %lu us coil-on per %d ms\n", (unsigned long)options.energy_max_on_us,
+               BENCH_ENERGY_WINDOW_US / 1000);
+    }
+    if (options.supply_idle_off_ms) {
+        printf("Supply off after %lu ms idle\n", (unsigned long)options.supply_idle_off_ms);
+    }
+    printf("%-11s %-14s %7s %7s %8s %10s %9s %8s %7s  %s\n",
+           "mode", "demo", "frames", "flips", "flips/s", "cpu/frame", "worst", "toggles", "faults", "panel");
+    printf("%-11s %-14s %7s %7s %8s %10s %9s %8s %7s\n",
+           "", "", "", "", "", "us", "ms", "/pulse", "");
+
+    for (int mode = 0; mode < SWEEP_MODE_COUNT; mode++) {
+        for (size_t i = 0; i < sizeof(bench_demos) / sizeof(bench_demos[0]); i++) {
+            bench_run((sweep_mode_t)mode, &bench_demos[i], &options, &config);
+        }
+    }
+    return 0;
+}
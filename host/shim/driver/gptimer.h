@@ -0,0 +1,21 @@
+/**
+ * @file gptimer.h
+ * @brief Host shim of the GPTimer handle types, the sim pulse engine has no timer
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef GPTIMER_H
+#define GPTIMER_H
+
+#include <stdint.h>
+
+typedef struct sim_gptimer *gptimer_handle_t;
+
+typedef struct {
+    uint64_t count_value;
+    uint64_t alarm_value;
+} gptimer_alarm_event_data_t;
+
+#endif /* GPTIMER_H */
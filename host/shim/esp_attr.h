@@ -0,0 +1,17 @@
+/**
+ * @file esp_attr.h
+ * @brief Host shim of the ESP-IDF placement attributes, all no-ops
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#endif /* ESP_ATTR_H */
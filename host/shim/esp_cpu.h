@@ -0,0 +1,18 @@
+/**
+ * @file esp_cpu.h
+ * @brief Host shim of the CPU cycle counter, one cycle per host nanosecond
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#endif /* ESP_CPU_H */
@@ -0,0 +1,16 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief Host shim of the ROM CRC32
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif /* ESP_ROM_CRC_H */
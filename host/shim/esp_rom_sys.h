@@ -0,0 +1,21 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief Host shim of the ROM delay and clock helpers
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef ESP_ROM_SYS_H
+#define ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
+
+// Matches the one-cycle-per-nanosecond host cycle counter
+static inline uint32_t esp_rom_get_cpu_ticks_per_us(void) {
+    return 1000;
+}
+
+#endif /* ESP_ROM_SYS_H */
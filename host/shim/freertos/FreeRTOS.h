@@ -0,0 +1,51 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host shim of the FreeRTOS base types
+ *
+ * The simulator runs everything on one host thread, so critical sections
+ * are no-ops and ticks are virtual milliseconds.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS  (1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)((ms) / portTICK_PERIOD_MS))
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+typedef struct {
+    uint32_t owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portMUX_INITIALIZE(mux)         ((mux)->owner = 0)
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)     ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)      ((void)(mux))
+#define portYIELD_FROM_ISR(woken)       ((void)(woken))
+#define configASSERT(x)                 ((void)(x))
+
+static inline BaseType_t xPortGetCoreID(void) {
+    return 0;
+}
+
+#endif /* FREERTOS_H */
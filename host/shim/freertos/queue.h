@@ -0,0 +1,22 @@
+/**
+ * @file queue.h
+ * @brief Host shim of the FreeRTOS queue API
+ *
+ * Only what the UART driver's event queue needs. No queue is ever created
+ * in the sim, so a receive always fails.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_queue *QueueHandle_t;
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif /* QUEUE_H */
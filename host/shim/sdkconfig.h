@@ -0,0 +1,21 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host build configuration for the flip dot simulator
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#define CONFIG_FLIP_DOT_HOST_SIM 1
+#define CONFIG_FLIP_DOT_STATS 1
+#define CONFIG_FLIP_DOT_MAX_PANELS 1
+#define CONFIG_FLIP_DOT_RENDER_TASK_CORE 1
+#define CONFIG_FLIP_DOT_RENDER_TASK_PRIORITY 10
+#define CONFIG_FLIP_DOT_INPUT_TASK_CORE 0
+#define CONFIG_FLIP_DOT_INPUT_TASK_PRIORITY 6
+#define CONFIG_FREERTOS_HZ 1000
+
+#endif /* SDKCONFIG_H */
@@ -0,0 +1,189 @@
+/**
+ * @file sim_panel.c
+ * @brief Simulated flip dot panel, implements the flip_dot_hal.h seam
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "sim_panel.h"
+#include "sim_rtos.h"
+#include "flip_dot_hal.h"
+#include <string.h>
+#include "esp_log.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "sim_panel";
+
+typedef struct {
+    sim_panel_config_t config;
+    uint32_t levels[2];         // Driven level of every GPIO, one word per bank
+    demux_74HC139_t enable_demux;
+    demux_74HC4514_t col_demux;
+    demux_74HC4514_t row_demux;
+    bool attached;
+    flip_dot_frame_t dots;      // Physical dot state
+    int64_t busy_until_us;      // End of the latest pulse, addresses must hold until then
+    int64_t last_release_us;
+    bool pulsed;
+    sim_panel_counters_t counters;
+} sim_panel_t;
+
+static sim_panel_t s_panel;
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static bool sim_panel_line(gpio_pin_t pin);
+static void sim_panel_set_levels(uint8_t bank, uint32_t levels);
+static bool sim_panel_decode(uint8_t *row, uint8_t *col, bool *value);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+// Logical level of an address line, considering inversion
+static bool sim_panel_line(gpio_pin_t pin) {
+    if (pin.pin == 0xFF) { // 0xFF indicates unused pin
+        return false;
+    }
+    bool level = s_panel.levels[pin.pin / 32] & (1UL << (pin.pin % 32));
+    return pin.is_inverted ? !level : level;
+}
+
+static void sim_panel_set_levels(uint8_t bank, uint32_t levels) {
+    uint32_t changed = levels ^ s_panel.levels[bank];
+    if (!changed) {
+        return;
+    }
+    if (sim_rtos_now_us() < s_panel.busy_until_us) {
+        s_panel.counters.glitches++;
+    }
+    s_panel.counters.line_toggles += __builtin_popcount(changed);
+    s_panel.levels[bank] = levels;
+}
+
+// Decodes the dot the address lines select. Output 0 of each 74HC4514 half
+// is not wired to a dot, A3 picks the set or reset half of the col demux.
+static bool sim_panel_decode(uint8_t *row, uint8_t *col, bool *value) {
+    uint8_t row_grp = sim_panel_line(s_panel.enable_demux.pin_1A0) | (sim_panel_line(s_panel.enable_demux.pin_1A1) << 1);
+    uint8_t row_pos = sim_panel_line(s_panel.row_demux.pin_A0) | (sim_panel_line(s_panel.row_demux.pin_A1) << 1) |
+                      (sim_panel_line(s_panel.row_demux.pin_A2) << 2);
+    uint8_t col_grp = sim_panel_line(s_panel.enable_demux.pin_2A0) | (sim_panel_line(s_panel.enable_demux.pin_2A1) << 1);
+    uint8_t col_pos = sim_panel_line(s_panel.col_demux.pin_A0) | (sim_panel_line(s_panel.col_demux.pin_A1) << 1) |
+                      (sim_panel_line(s_panel.col_demux.pin_A2) << 2);
+
+    if (row_pos == 0 || col_pos == 0) {
+        return false;
+    }
+    *row = row_grp * 7 + row_pos - 1;
+    *col = col_grp * 7 + col_pos - 1;
+    *value = sim_panel_line(s_panel.col_demux.pin_A3);
+    return *row < DISPLAY_HEIGHT && *col < DISPLAY_WIDTH;
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+sim_panel_config_t sim_panel_get_default_config(void) {
+    sim_panel_config_t config = {
+        .supply_mv = 2200,
+        .nominal_mv = 2200,
+        .min_pulse_us = 1500,
+        .min_recovery_us = 600,
+    };
+    return config;
+}
+
+void sim_panel_init(const sim_panel_config_t *config) {
+    memset(&s_panel, 0, sizeof(s_panel));
+    s_panel.config = *config;
+}
+
+void sim_panel_attach(const flip_dot_t *display) {
+    s_panel.enable_demux = display->enable_demux;
+    s_panel.col_demux = display->col_demux;
+    s_panel.row_demux = display->row_demux;
+    s_panel.attached = true;
+}
+
+void sim_panel_set_supply(int supply_mv) {
+    s_panel.config.supply_mv = supply_mv;
+}
+
+esp_err_t sim_panel_read_supply(int *voltage_mv) {
+    *voltage_mv = s_panel.config.supply_mv;
+    return ESP_OK;
+}
+
+const flip_dot_frame_t *sim_panel_get_frame(void) {
+    return &s_panel.dots;
+}
+
+void sim_panel_get_counters(sim_panel_counters_t *counters) {
+    *counters = s_panel.counters;
+}
+
+void sim_panel_reset_counters(void) {
+    memset(&s_panel.counters, 0, sizeof(s_panel.counters));
+}
+
+void sim_panel_pulse(int64_t start_us, uint32_t pulse_us) {
+    sim_panel_counters_t *counters = &s_panel.counters;
+    counters->pulses++;
+    counters->pulse_us += pulse_us;
+
+    // Short of the recovery gap the capacitor cannot deliver a full pulse
+    bool recovered = !s_panel.pulsed || start_us - s_panel.last_release_us >= s_panel.config.min_recovery_us;
+    // A switched off supply flips nothing
+    uint32_t needed_us = s_panel.config.supply_mv > 0
+        ? (uint64_t)s_panel.config.min_pulse_us * s_panel.config.nominal_mv / s_panel.config.supply_mv
+        : UINT32_MAX;
+    s_panel.busy_until_us = start_us + pulse_us;
+    s_panel.last_release_us = start_us + pulse_us;
+    s_panel.pulsed = true;
+
+    uint8_t row, col;
+    bool value;
+    if (!s_panel.attached || !sim_panel_decode(&row, &col, &value)) {
+        counters->stray++;
+        return;
+    }
+    if (!recovered || pulse_us < needed_us) {
+        counters->misfires++;
+        ESP_LOGD(TAG, "Misfire at (%d,%d): %u us pulse, %u us needed", row, col, pulse_us, needed_us);
+        return;
+    }
+    if (flip_dot_frame_get(&s_panel.dots, row, col) == value) {
+        counters->redundant++;
+        return;
+    }
+    flip_dot_frame_set(&s_panel.dots, row, col, value);
+    counters->flips++;
+}
+
+/******************************************************************************
+ * flip_dot_hal.h
+ ******************************************************************************/
+
+void flip_dot_hal_config_outputs(uint64_t pin_mask) {
+}
+
+void flip_dot_hal_gpio_write(uint8_t pin, bool level) {
+    uint32_t levels = s_panel.levels[pin / 32];
+    uint32_t bit = 1UL << (pin % 32);
+    sim_panel_set_levels(pin / 32, level ? levels | bit : levels & ~bit);
+}
+
+void flip_dot_hal_bank_write(uint8_t bank, uint32_t set_mask, uint32_t clear_mask) {
+    sim_panel_set_levels(bank, (s_panel.levels[bank] & ~clear_mask) | set_mask);
+}
+
+void flip_dot_hal_delay_us(uint32_t us) {
+    sim_rtos_advance_to(sim_rtos_now_us() + us);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file sim_panel.h
+ * @brief Simulated flip dot panel behind the driver's pin access seam
+ *
+ * The panel decodes the row/col address lines the same way the 74HC139 and
+ * 74HC4514 demuxes do, and flips the addressed dot when the pulse engine
+ * drives a coil pulse that is long enough for the supply voltage and comes
+ * after enough recovery time. It counts every pulse and address line
+ * toggle, and flags address changes made while a coil pulse is in flight.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef SIM_PANEL_H
+#define SIM_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+// Coil model
+typedef struct {
+    int supply_mv;              // Coil supply as returned by sim_panel_read_supply()
+    int nominal_mv;             // Supply min_pulse_us was measured at
+    uint32_t min_pulse_us;      // Shortest pulse that flips a dot at nominal_mv, scales with 1/supply
+    uint32_t min_recovery_us;   // Shortest gap the supply capacitor needs between pulses
+} sim_panel_config_t;
+
+// Panel counters since the last sim_panel_reset_counters()
+typedef struct {
+    uint32_t pulses;            // Coil pulses seen
+    uint32_t flips;             // Pulses that changed a dot
+    uint32_t redundant;         // Pulses on a dot already in the addressed state
+    uint32_t misfires;          // Pulses too short, or too soon after the previous one
+    uint32_t stray;             // Pulses with no valid dot addressed
+    uint32_t glitches;          // Address writes while a pulse was queued or in flight
+    uint64_t line_toggles;      // Address line level changes
+    uint64_t pulse_us;          // Time a coil was driven
+} sim_panel_counters_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+sim_panel_config_t sim_panel_get_default_config(void);
+void sim_panel_init(const sim_panel_config_t *config);
+
+// Learns the pin map from an initialised display, call after flip_dot_init()
+void sim_panel_attach(const flip_dot_t *display);
+
+void sim_panel_set_supply(int supply_mv);
+esp_err_t sim_panel_read_supply(int *voltage_mv);
+
+const flip_dot_frame_t *sim_panel_get_frame(void);
+void sim_panel_get_counters(sim_panel_counters_t *counters);
+void sim_panel_reset_counters(void);
+
+// Called by the simulated pulse engine for each pulse it starts
+void sim_panel_pulse(int64_t start_us, uint32_t pulse_us);
+
+#endif /* SIM_PANEL_H */
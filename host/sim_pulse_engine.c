@@ -0,0 +1,84 @@
+/**
+ * @file sim_pulse_engine.c
+ * @brief pulse_engine.h on the virtual clock, replaces pulse_engine.c in host builds
+ *
+ * Pulses are scheduled back to back the way the timer ISR chains them:
+ * a queued pulse starts when the previous recovery gap ends. Waits move
+ * the virtual clock to the release or the end of recovery. Only one engine
+ * is simulated, which is all a single panel needs.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "pulse_engine.h"
+#include "sim_panel.h"
+#include "sim_rtos.h"
+#include "esp_log.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "sim_pulse_engine";
+
+static int64_t s_release_us;    // When the enable line of the latest pulse drops
+static int64_t s_idle_us;       // When the latest recovery gap ends
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t pulse_engine_init(pulse_engine_t *engine, uint8_t pin, bool is_inverted) {
+    engine->timer = NULL;
+    engine->done = NULL;
+    engine->released = NULL;
+    engine->pin = pin;
+    engine->phase = PULSE_PHASE_IDLE;
+    engine->queued = false;
+    engine->awaiting_release = false;
+    engine->chain_active = false;
+    s_release_us = sim_rtos_now_us();
+    s_idle_us = s_release_us;
+
+    ESP_LOGI(TAG, "Simulated pulse engine on GPIO%d", pin);
+    return ESP_OK;
+}
+
+void pulse_engine_deinit(pulse_engine_t *engine) {
+    pulse_engine_wait_idle(engine);
+}
+
+void pulse_engine_fire(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us) {
+    pulse_engine_queue(engine, pulse_us, recovery_us);
+    pulse_engine_wait_idle(engine);
+}
+
+void pulse_engine_wait_released(pulse_engine_t *engine) {
+    sim_rtos_advance_to(s_release_us);
+}
+
+void pulse_engine_queue(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us) {
+    int64_t start_us = sim_rtos_now_us();
+    if (start_us < s_idle_us) {
+        start_us = s_idle_us;
+    }
+    engine->recovery_us = recovery_us;
+    sim_panel_pulse(start_us, pulse_us);
+    s_release_us = start_us + pulse_us;
+    s_idle_us = s_release_us + recovery_us;
+}
+
+void pulse_engine_wait_idle(pulse_engine_t *engine) {
+    sim_rtos_advance_to(s_idle_us);
+}
+
+// Single core, nothing to move
+esp_err_t pulse_engine_bind_to_current_core(pulse_engine_t *engine) {
+    return ESP_OK;
+}
+
+// One simulated panel never waits on other panels' pulses
+void pulse_engine_set_power_tokens(pulse_engine_t *engine, SemaphoreHandle_t tokens) {
+    engine->power_tokens = tokens;
+}
@@ -0,0 +1,374 @@
+/**
+ * @file sim_rtos.c
+ * @brief Host implementation of the FreeRTOS, esp_timer, ROM and log shims
+ *
+ * There is exactly one simulated task, the one running the benchmark. It
+ * may block on its notification value; the only things that can wake it up
+ * are esp_timer callbacks, which run in its context as virtual time passes.
+ * Task creation fails, so the driver stays on its synchronous fallback.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "sim_rtos.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "sim_rtos";
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool used;
+    bool active;
+    int64_t due_us;
+    uint64_t period_us;     // 0 for one-shot timers
+};
+
+struct sim_task {
+    uint32_t notify_value;
+    bool notify_pending;
+};
+
+static int64_t s_now_us;
+static struct esp_timer s_timers[SIM_RTOS_MAX_TIMERS];
+static struct sim_task s_task;
+
+esp_log_level_t sim_log_level = ESP_LOG_WARN;
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static struct esp_timer *sim_rtos_next_timer(void);
+static bool sim_rtos_wait_notify(TickType_t timeout);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+// Earliest active timer, NULL when none is armed
+static struct esp_timer *sim_rtos_next_timer(void) {
+    struct esp_timer *next = NULL;
+    for (int i = 0; i < SIM_RTOS_MAX_TIMERS; i++) {
+        struct esp_timer *timer = &s_timers[i];
+        if (timer->used && timer->active && (!next || timer->due_us < next->due_us)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+// Lets virtual time pass until the task is notified or the timeout expires
+static bool sim_rtos_wait_notify(TickType_t timeout) {
+    int64_t deadline = timeout == portMAX_DELAY ? INT64_MAX
+                                                : s_now_us + (int64_t)timeout * portTICK_PERIOD_MS * 1000;
+    while (!s_task.notify_pending) {
+        struct esp_timer *next = sim_rtos_next_timer();
+        if (!next || next->due_us > deadline) {
+            if (deadline == INT64_MAX) {
+                // Nothing armed could ever wake the task, do not hang the host
+                ESP_LOGW(TAG, "Blocking forever with no timer armed");
+                return false;
+            }
+            sim_rtos_advance_to(deadline);
+            return false;
+        }
+        sim_rtos_advance_to(next->due_us);
+    }
+    return true;
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+void sim_rtos_reset(void) {
+    s_now_us = 0;
+    memset(s_timers, 0, sizeof(s_timers));
+    memset(&s_task, 0, sizeof(s_task));
+}
+
+int64_t sim_rtos_now_us(void) {
+    return s_now_us;
+}
+
+void sim_rtos_advance_to(int64_t time_us) {
+    struct esp_timer *next;
+    while ((next = sim_rtos_next_timer()) != NULL && next->due_us <= time_us) {
+        if (next->due_us > s_now_us) {
+            s_now_us = next->due_us;
+        }
+        if (next->period_us) {
+            next->due_us += next->period_us;
+        } else {
+            next->active = false;
+        }
+        next->args.callback(next->args.arg);
+    }
+    if (time_us > s_now_us) {
+        s_now_us = time_us;
+    }
+}
+
+int64_t sim_rtos_cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/******************************************************************************
+ * esp_timer
+ ******************************************************************************/
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    for (int i = 0; i < SIM_RTOS_MAX_TIMERS; i++) {
+        if (!s_timers[i].used) {
+            memset(&s_timers[i], 0, sizeof(s_timers[i]));
+            s_timers[i].args = *create_args;
+            s_timers[i].used = true;
+            *out_handle = &s_timers[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->period_us = 0;
+    timer->due_us = s_now_us + timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->period_us = period_us;
+    timer->due_us = s_now_us + period_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (timer->period_us) {
+        timer->period_us = timeout_us;
+    }
+    timer->due_us = s_now_us + timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->used = false;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer->active;
+}
+
+int64_t esp_timer_get_time(void) {
+    return s_now_us;
+}
+
+/******************************************************************************
+ * FreeRTOS tasks and notifications
+ ******************************************************************************/
+
+void vTaskDelay(TickType_t ticks) {
+    sim_rtos_advance_to(s_now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(s_now_us / (portTICK_PERIOD_MS * 1000));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return &s_task;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *out_task,
+                                   BaseType_t core_id) {
+    // Single task only, callers fall back to running synchronously
+    if (out_task) {
+        *out_task = NULL;
+    }
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    switch (action) {
+    case eSetBits:
+        task->notify_value |= value;
+        break;
+    case eIncrement:
+        task->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+    case eSetValueWithoutOverwrite:
+        task->notify_value = value;
+        break;
+    default:
+        break;
+    }
+    task->notify_pending = true;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout) {
+    if (!sim_rtos_wait_notify(timeout)) {
+        return 0;
+    }
+    uint32_t value = s_task.notify_value;
+    s_task.notify_value = clear_on_exit ? 0 : value - 1;
+    s_task.notify_pending = s_task.notify_value != 0;
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t timeout) {
+    if (!s_task.notify_pending) {
+        s_task.notify_value &= ~clear_on_entry;
+    }
+    if (!sim_rtos_wait_notify(timeout)) {
+        return pdFALSE;
+    }
+    if (value) {
+        *value = s_task.notify_value;
+    }
+    s_task.notify_value &= ~clear_on_exit;
+    s_task.notify_pending = false;
+    return pdTRUE;
+}
+
+/******************************************************************************
+ * FreeRTOS semaphores
+ ******************************************************************************/
+
+struct sim_semaphore {
+    bool taken;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return calloc(1, sizeof(struct sim_semaphore));
+}
+
+// Binary semaphores start out empty
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(struct sim_semaphore));
+    if (semaphore) {
+        semaphore->taken = true;
+    }
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout) {
+    if (semaphore->taken) {
+        return pdFALSE;
+    }
+    semaphore->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (!semaphore->taken) {
+        return pdFALSE;
+    }
+    semaphore->taken = false;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    free(semaphore);
+}
+
+/******************************************************************************
+ * ROM, CPU and log helpers
+ ******************************************************************************/
+
+void esp_rom_delay_us(uint32_t us) {
+    sim_rtos_advance_to(s_now_us + us);
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    default:                    return "UNKNOWN ERROR";
+    }
+}
+
+void sim_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char level_chars[] = "NEWIDV";
+    va_list args;
+    fprintf(stderr, "%c (%lld) %s: ", level_chars[level], (long long)(s_now_us / 1000), tag);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
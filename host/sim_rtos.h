@@ -0,0 +1,41 @@
+/**
+ * @file sim_rtos.h
+ * @brief Virtual clock behind the host shims of FreeRTOS and esp_timer
+ *
+ * Nothing in the simulator sleeps. Delays, notification waits and pulse
+ * engine waits move the virtual clock forward and run the esp_timer
+ * callbacks that fall due on the way, so a minute of game play takes a
+ * fraction of a second of host time.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef SIM_RTOS_H
+#define SIM_RTOS_H
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define SIM_RTOS_MAX_TIMERS 8
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Back to time zero, no timers and no pending notifications
+void sim_rtos_reset(void);
+
+// Virtual time in microseconds, what esp_timer_get_time() returns
+int64_t sim_rtos_now_us(void);
+
+// Moves the virtual clock to time_us, firing due timers in order. Never goes back.
+void sim_rtos_advance_to(int64_t time_us);
+
+// Host CPU time used by this process, for measuring driver cost
+int64_t sim_rtos_cpu_time_ns(void);
+
+#endif /* SIM_RTOS_H */
@@ -0,0 +1,71 @@
+/**
+ * @file sim_stubs.c
+ * @brief Host stand-ins for the UART driver and ESP-NOW, no input in the sim
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "input.h"
+#include "driver/uart.h"
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num) {
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    return 0;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    return (int)size;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size) {
+    *size = 0;
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    return ESP_OK;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout) {
+    return pdFALSE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    return pdPASS;
+}
+
+esp_err_t input_espnow_init(input_system_t *input_sys) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void input_espnow_process(input_system_t *input_sys) {
+}
+
+espnow_input_config_t input_get_default_espnow_config(void) {
+    espnow_input_config_t config = {
+        .channel = 1,
+        .enable_encryption = false,
+    };
+    return config;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file display_server.c
+ * @brief Display server mode, a remote host streams frames to the panel
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "display_server.h"
+#include <string.h>
+#include "esp_log.h"
+#include "input.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "display_server";
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static uint16_t read_u16(const uint8_t *p);
+static uint32_t read_u32(const uint8_t *p);
+static void display_server_apply_keyframe(display_server_t *server, const uint8_t *payload);
+static bool display_server_apply_delta(display_server_t *server, const uint8_t *payload, int len);
+static void display_server_lost_sync(display_server_t *server);
+static bool display_server_espnow_hook(const uint8_t *src_mac, const uint8_t *data, int len, void *ctx);
+static void display_server_task(void *arg);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static uint16_t read_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void display_server_apply_keyframe(display_server_t *server, const uint8_t *payload) {
+    flip_dot_frame_t frame;
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        frame.rows[r] = read_u32(&payload[r * 4]) & FLIP_DOT_ROW_MASK;
+    }
+    flip_dot_submit_frame_packed(server->display, &frame);
+}
+
+static bool display_server_apply_delta(display_server_t *server, const uint8_t *payload, int len) {
+    uint8_t count = payload[0];
+    if (count > DISPLAY_SERVER_MAX_DELTA_CHANGES || len != 1 + count * 2) {
+        return false;
+    }
+
+    flip_dot_change_t changes[DISPLAY_SERVER_MAX_DELTA_CHANGES];
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t change = read_u16(&payload[1 + i * 2]);
+        uint16_t index = change & DISPLAY_SERVER_CHANGE_INDEX_MASK;
+        if (index >= DISPLAY_PIXEL_COUNT) {
+            return false;
+        }
+        changes[i] = (flip_dot_change_t){
+            .row = index / DISPLAY_WIDTH,
+            .col = index % DISPLAY_WIDTH,
+            .value = (change & DISPLAY_SERVER_CHANGE_VALUE_BIT) != 0,
+        };
+    }
+    // One call, so the renderer never sees half a delta
+    flip_dot_apply_changes(server->display, changes, count);
+    return true;
+}
+
+// Ignore deltas until the next keyframe and have the task ask for one
+static void display_server_lost_sync(display_server_t *server) {
+    server->synced = false;
+    if (!server->keyframe_wanted) {
+        // First request goes out now, the task repeats it from there
+        server->keyframe_wanted = true;
+        xTaskNotifyGive(server->task);
+    }
+}
+
+// Runs in the WiFi task
+static bool display_server_espnow_hook(const uint8_t *src_mac, const uint8_t *data, int len, void *ctx) {
+    display_server_t *server = ctx;
+    if (len < DISPLAY_SERVER_HEADER_SIZE || data[0] != DISPLAY_SERVER_PACKET_MAGIC) {
+        return false;
+    }
+    portENTER_CRITICAL(&server->lock);
+    memcpy(server->host_mac, src_mac, sizeof(server->host_mac));
+    portEXIT_CRITICAL(&server->lock);
+    return display_server_handle_packet(server, data, len);
+}
+
+// Sends keyframe requests outside the WiFi task, esp_now_send() should not
+// be called from the receive callback
+static void display_server_task(void *arg) {
+    display_server_t *server = arg;
+    uint8_t request[DISPLAY_SERVER_HEADER_SIZE] = { DISPLAY_SERVER_PACKET_MAGIC, DISPLAY_SERVER_TYPE_KEYFRAME_REQUEST };
+    uint8_t host_mac[sizeof(server->host_mac)];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, server->keyframe_wanted ? pdMS_TO_TICKS(DISPLAY_SERVER_KEYFRAME_RETRY_MS) : portMAX_DELAY);
+        if (!server->keyframe_wanted) {
+            continue;
+        }
+
+        // The WiFi task writes both while packets arrive
+        portENTER_CRITICAL(&server->lock);
+        uint16_t seq = server->last_seq;
+        memcpy(host_mac, server->host_mac, sizeof(host_mac));
+        portEXIT_CRITICAL(&server->lock);
+
+        request[2] = seq & 0xFF;
+        request[3] = seq >> 8;
+        esp_err_t ret = input_espnow_send_to(host_mac, request, sizeof(request));
+        if (ret == ESP_OK) {
+            server->stats.keyframe_requests++;
+        } else {
+            ESP_LOGW(TAG, "Keyframe request failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t display_server_start(display_server_t *server, flip_dot_t *display) {
+    // Packets are applied in the WiFi task, without a render task they would
+    // draw right there
+    if (!display->renderer.task) {
+        ESP_LOGE(TAG, "Display server needs the render task");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(server, 0, sizeof(*server));
+    server->display = display;
+    portMUX_INITIALIZE(&server->lock);
+
+    // Next to the WiFi task that feeds it packets
+    BaseType_t created = xTaskCreatePinnedToCore(display_server_task, "display_server",
+                                                 DISPLAY_SERVER_TASK_STACK_SIZE, server,
+                                                 DISPLAY_SERVER_TASK_PRIORITY, &server->task,
+                                                 DISPLAY_SERVER_TASK_CORE);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create display server task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    input_espnow_set_packet_handler(display_server_espnow_hook, server);
+    ESP_LOGI(TAG, "Display server waiting for frames");
+    return ESP_OK;
+}
+
+bool display_server_handle_packet(display_server_t *server, const uint8_t *data, int len) {
+    if (len < DISPLAY_SERVER_HEADER_SIZE || data[0] != DISPLAY_SERVER_PACKET_MAGIC) {
+        return false;
+    }
+
+    uint8_t type = data[1];
+    uint16_t seq = read_u16(&data[2]);
+    const uint8_t *payload = &data[DISPLAY_SERVER_HEADER_SIZE];
+    int payload_len = len - DISPLAY_SERVER_HEADER_SIZE;
+
+    // Sequence numbers wrap, compare by signed distance
+    int16_t ahead = (int16_t)(seq - server->last_seq);
+
+    switch (type) {
+    case DISPLAY_SERVER_TYPE_KEYFRAME:
+        if (len != DISPLAY_SERVER_KEYFRAME_SIZE) {
+            server->stats.malformed++;
+            break;
+        }
+        // Anything ahead resyncs. Only the very first keyframe may be behind,
+        // there is no sequence to compare it with yet. After a gap a keyframe
+        // behind is a stale reordered one and would roll the panel back.
+        if (server->ever_synced && ahead <= 0) {
+            server->stats.late++;
+            break;
+        }
+        display_server_apply_keyframe(server, payload);
+        portENTER_CRITICAL(&server->lock);
+        server->last_seq = seq;
+        portEXIT_CRITICAL(&server->lock);
+        server->synced = true;
+        server->ever_synced = true;
+        server->keyframe_wanted = false;
+        server->stats.keyframes++;
+        break;
+
+    case DISPLAY_SERVER_TYPE_DELTA:
+        if (!server->synced) {
+            server->stats.gaps++;
+            display_server_lost_sync(server);
+            break;
+        }
+        if (ahead <= 0) {
+            server->stats.late++;
+            break;
+        }
+        if (ahead > 1) {
+            server->stats.gaps++;
+            display_server_lost_sync(server);
+            break;
+        }
+        if (payload_len < 1 || !display_server_apply_delta(server, payload, payload_len)) {
+            // The panel no longer matches the host either way
+            server->stats.malformed++;
+            display_server_lost_sync(server);
+            break;
+        }
+        portENTER_CRITICAL(&server->lock);
+        server->last_seq = seq;
+        portEXIT_CRITICAL(&server->lock);
+        server->stats.deltas++;
+        break;
+
+    default:
+        server->stats.malformed++;
+        break;
+    }
+    return true;
+}
+
+void display_server_get_stats(display_server_t *server, display_server_stats_t *stats) {
+    *stats = server->stats;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file display_server.h
+ * @brief Display server mode, a remote host streams frames to the panel
+ *
+ * Frames arrive as ESP-NOW packets and go straight into the async renderer,
+ * so the host drives the panel at its full flip rate. Packets, little-endian:
+ *
+ *   header    magic 0xFD, type, uint16 sequence number
+ *   keyframe  header + DISPLAY_HEIGHT uint32 rows, packed like flip_dot_frame_t
+ *   delta     header + uint8 count + count uint16 changes, bits 0-8 the dot
+ *             index row * DISPLAY_WIDTH + col, bit 15 the new value
+ *   request   header with the last sequence applied, sent back to the host
+ *             to ask for a keyframe
+ *
+ * Every packet takes the next sequence number. Packets at or behind the last
+ * applied one are late and dropped. A delta that skips ahead means one was
+ * lost: it is dropped, deltas are ignored until the next keyframe and a
+ * keyframe request goes to the host, repeated until one arrives.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef DISPLAY_SERVER_H
+#define DISPLAY_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define DISPLAY_SERVER_PACKET_MAGIC 0xFD
+#define DISPLAY_SERVER_HEADER_SIZE 4
+
+#define DISPLAY_SERVER_TYPE_KEYFRAME 1
+#define DISPLAY_SERVER_TYPE_DELTA 2
+#define DISPLAY_SERVER_TYPE_KEYFRAME_REQUEST 3
+
+#define DISPLAY_SERVER_KEYFRAME_SIZE (DISPLAY_SERVER_HEADER_SIZE + DISPLAY_HEIGHT * 4)
+
+// Most changes one delta fits into an ESP-NOW packet
+#define DISPLAY_SERVER_MAX_DELTA_CHANGES 120
+
+#define DISPLAY_SERVER_CHANGE_INDEX_MASK 0x01FF
+#define DISPLAY_SERVER_CHANGE_VALUE_BIT 0x8000
+
+// Keyframe requests repeat at this interval until a keyframe arrives
+#define DISPLAY_SERVER_KEYFRAME_RETRY_MS 100
+
+#define DISPLAY_SERVER_TASK_STACK_SIZE 3072
+#define DISPLAY_SERVER_TASK_PRIORITY CONFIG_FLIP_DOT_INPUT_TASK_PRIORITY
+#define DISPLAY_SERVER_TASK_CORE CONFIG_FLIP_DOT_INPUT_TASK_CORE
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    uint32_t keyframes;         // Keyframes applied
+    uint32_t deltas;            // Deltas applied
+    uint32_t late;              // Dropped, at or behind the last applied sequence
+    uint32_t gaps;              // Deltas dropped because one before them was lost
+    uint32_t malformed;         // Bad length or dot index
+    uint32_t keyframe_requests; // Requests sent to the host
+} display_server_stats_t;
+
+typedef struct {
+    flip_dot_t *display;
+    TaskHandle_t task;          // Sends the keyframe requests
+    uint16_t last_seq;          // Last sequence applied
+    bool synced;                // A keyframe has been applied since the last gap
+    bool ever_synced;           // A keyframe has been applied at all
+    volatile bool keyframe_wanted;
+    portMUX_TYPE lock;          // Guards host_mac and last_seq for the task
+    uint8_t host_mac[6];        // Sender of the latest packet, requests go there
+    display_server_stats_t stats;
+} display_server_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Takes over ESP-NOW packets tagged DISPLAY_SERVER_PACKET_MAGIC, ESP-NOW must
+// already be up through the input system. The display's render task must run.
+esp_err_t display_server_start(display_server_t *server, flip_dot_t *display);
+
+// Applies one packet. Transport independent, the ESP-NOW hook ends up here.
+// Returns false for packets that are not display server packets.
+bool display_server_handle_packet(display_server_t *server, const uint8_t *data, int len);
+
+void display_server_get_stats(display_server_t *server, display_server_stats_t *stats);
+
+#endif /* DISPLAY_SERVER_H */
@@ -0,0 +1,39 @@
+/**
+ * @file fixed_math.h
+ * @brief Fixed-point sin/cos and integer square root for the demo generators
+ *
+ * Lookup-table based, no floating point, so frame generation stays cheap
+ * next to the WiFi stack on the same core.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FIXED_MATH_H
+#define FIXED_MATH_H
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+// Angles are in 1/1024ths of a turn and wrap around, any uint32_t is valid
+#define FIXED_ANGLE_BITS 10
+#define FIXED_ANGLE_FULL (1UL << FIXED_ANGLE_BITS)
+#define FIXED_ANGLE_QUARTER (FIXED_ANGLE_FULL / 4)
+
+// sin/cos results are Q15, FIXED_ONE is 1.0
+#define FIXED_ONE 32767
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+int16_t fixed_sin(uint32_t angle);
+int16_t fixed_cos(uint32_t angle);
+
+// Floor of the square root
+uint16_t fixed_isqrt(uint32_t value);
+
+#endif /* FIXED_MATH_H */
@@ -0,0 +1,234 @@
+/**
+ * @file flip_anim.c
+ * @brief Pre-baked flip dot animations played straight from flash
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "flip_anim.h"
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_anim";
+
+// Skip field value that means a LEB128 extension follows the token
+#define FLIP_ANIM_SKIP_EXTENDED 7
+
+// Longest LEB128 skip extension, enough for any dot index
+#define FLIP_ANIM_SKIP_MAX_BYTES 3
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static uint16_t read_u16(const uint8_t *p);
+static uint32_t read_u32(const uint8_t *p);
+static bool flip_anim_header_blank(const uint8_t *header);
+static esp_err_t flip_anim_validate(flip_anim_t *anim);
+static esp_err_t flip_anim_play_frame(flip_dot_t *display, const uint8_t *payload, uint16_t size);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static uint16_t read_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Erased flash reads 0xFF, a zero-filled image reads 0x00
+static bool flip_anim_header_blank(const uint8_t *header) {
+    for (int i = 1; i < FLIP_ANIM_HEADER_SIZE; i++) {
+        if (header[i] != header[0]) {
+            return false;
+        }
+    }
+    return header[0] == 0xFF || header[0] == 0x00;
+}
+
+// Walks the frame headers once so playback never runs off the end
+static esp_err_t flip_anim_validate(flip_anim_t *anim) {
+    const uint8_t *header = anim->data;
+
+    // Nothing flashed yet is the normal state, not a fault
+    if (anim->size < FLIP_ANIM_HEADER_SIZE || flip_anim_header_blank(header)) {
+        ESP_LOGI(TAG, "No animation flashed");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (memcmp(header, FLIP_ANIM_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "Bad animation magic %02x %02x %02x %02x", header[0], header[1], header[2], header[3]);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (header[4] != FLIP_ANIM_VERSION) {
+        ESP_LOGE(TAG, "Unsupported animation version %d", header[4]);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (header[5] != DISPLAY_WIDTH || header[6] != DISPLAY_HEIGHT) {
+        ESP_LOGE(TAG, "Animation is %dx%d, panel is %dx%d", header[5], header[6], DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t frame_count = read_u32(&header[8]);
+    uint32_t data_size = read_u32(&header[12]);
+    if (data_size > anim->size - FLIP_ANIM_HEADER_SIZE) {
+        ESP_LOGE(TAG, "Animation truncated, %lu of %lu bytes", (unsigned long)(anim->size - FLIP_ANIM_HEADER_SIZE),
+                 (unsigned long)data_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t offset = FLIP_ANIM_HEADER_SIZE;
+    size_t end = FLIP_ANIM_HEADER_SIZE + data_size;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        if (end - offset < FLIP_ANIM_FRAME_HEADER_SIZE) {
+            ESP_LOGE(TAG, "Frame %lu header past the end", (unsigned long)i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        offset += FLIP_ANIM_FRAME_HEADER_SIZE;
+        uint16_t payload_size = read_u16(&anim->data[offset - 2]);
+        if (end - offset < payload_size) {
+            ESP_LOGE(TAG, "Frame %lu payload past the end", (unsigned long)i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        offset += payload_size;
+    }
+
+    anim->frame_count = frame_count;
+    anim->size = end;
+    return ESP_OK;
+}
+
+// Decodes one flip list into the driver a chunk at a time
+static esp_err_t flip_anim_play_frame(flip_dot_t *display, const uint8_t *payload, uint16_t size) {
+    flip_dot_change_t changes[FLIP_ANIM_CHUNK_CHANGES];
+    uint16_t count = 0;
+    uint16_t cursor = 0;
+    uint16_t pos = 0;
+
+    while (pos < size) {
+        uint8_t token = payload[pos++];
+        uint32_t skip = (token >> 4) & 0x07;
+        if (skip == FLIP_ANIM_SKIP_EXTENDED) {
+            uint8_t byte;
+            uint8_t skip_bytes = 0;
+            do {
+                if (pos >= size || skip_bytes == FLIP_ANIM_SKIP_MAX_BYTES) {
+                    return ESP_ERR_INVALID_SIZE;
+                }
+                byte = payload[pos++];
+                skip += (uint32_t)(byte & 0x7F) << (7 * skip_bytes++);
+            } while (byte & 0x80);
+        }
+
+        bool value = token & 0x80;
+        uint16_t run = (token & 0x0F) + 1;
+        if (cursor + skip + run > DISPLAY_PIXEL_COUNT) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        cursor += skip;
+
+        // Walk row and column along with the run instead of dividing per dot
+        uint8_t row = cursor / DISPLAY_WIDTH;
+        uint8_t col = cursor % DISPLAY_WIDTH;
+        cursor += run;
+        while (run--) {
+            changes[count++] = (flip_dot_change_t){ .row = row, .col = col, .value = value };
+            if (++col == DISPLAY_WIDTH) {
+                col = 0;
+                row++;
+            }
+            if (count == FLIP_ANIM_CHUNK_CHANGES) {
+                flip_dot_apply_changes(display, changes, count);
+                count = 0;
+            }
+        }
+    }
+
+    if (count) {
+        flip_dot_apply_changes(display, changes, count);
+    }
+    return ESP_OK;
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t flip_anim_open_partition(flip_anim_t *anim, const char *label) {
+    memset(anim, 0, sizeof(*anim));
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        ESP_LOGW(TAG, "No partition labelled %s", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *data;
+    esp_err_t ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &anim->mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map partition %s: %s", label, esp_err_to_name(ret));
+        return ret;
+    }
+    anim->mapped = true;
+    anim->data = data;
+    anim->size = partition->size;
+
+    ret = flip_anim_validate(anim);
+    if (ret != ESP_OK) {
+        flip_anim_close(anim);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Animation in %s: %lu frames, %u bytes", label, (unsigned long)anim->frame_count, (unsigned)anim->size);
+    return ESP_OK;
+}
+
+esp_err_t flip_anim_open_buffer(flip_anim_t *anim, const uint8_t *data, size_t size) {
+    memset(anim, 0, sizeof(*anim));
+    anim->data = data;
+    anim->size = size;
+    return flip_anim_validate(anim);
+}
+
+void flip_anim_close(flip_anim_t *anim) {
+    if (anim->mapped) {
+        esp_partition_munmap(anim->mmap_handle);
+    }
+    memset(anim, 0, sizeof(*anim));
+}
+
+esp_err_t flip_anim_play(const flip_anim_t *anim, flip_dot_t *display, uint32_t loops) {
+    if (!anim->data || anim->frame_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t wake = xTaskGetTickCount();
+    for (uint32_t loop = 0; loops == 0 || loop < loops; loop++) {
+        size_t offset = FLIP_ANIM_HEADER_SIZE;
+        for (uint32_t i = 0; i < anim->frame_count; i++) {
+            const uint8_t *frame = &anim->data[offset];
+            uint16_t duration_ms = read_u16(&frame[0]);
+            uint16_t payload_size = read_u16(&frame[2]);
+
+            esp_err_t ret = flip_anim_play_frame(display, &frame[FLIP_ANIM_FRAME_HEADER_SIZE], payload_size);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Bad flip list in frame %lu", (unsigned long)i);
+                return ret;
+            }
+            offset += FLIP_ANIM_FRAME_HEADER_SIZE + payload_size;
+
+            // Pace on the absolute schedule so decode time doesn't add up
+            vTaskDelayUntil(&wake, pdMS_TO_TICKS(duration_ms) ? pdMS_TO_TICKS(duration_ms) : 1);
+        }
+    }
+    return ESP_OK;
+}
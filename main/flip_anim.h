@@ -0,0 +1,78 @@
+/**
+ * @file flip_anim.h
+ * @brief Pre-baked flip dot animations played straight from flash
+ *
+ * Animations are authored offline and encoded with tools/flip_anim.py. The
+ * player maps the file from the "anim" data partition and feeds each frame's
+ * flip list into flip_dot_apply_changes() a chunk at a time, so no frame is
+ * ever decoded into RAM and sequences can be far larger than SRAM.
+ *
+ * File layout, little-endian:
+ *
+ *   header   "FDAN", version, width, height, flags (0),
+ *            uint32 frame_count, uint32 data_size (bytes after the header)
+ *   frame    uint16 duration_ms, uint16 payload_size, payload
+ *   payload  runs over the row-major dot index, each one token byte: bit 7
+ *            the dot value, bits 4-6 the skip from the end of the previous
+ *            run, bits 0-3 the run length minus one. A skip field of 7 is
+ *            followed by a LEB128 holding the rest of the skip.
+ *
+ * The first frame is a keyframe covering every dot, later frames only list
+ * the dots that change, so looping back to the start needs no clear.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_ANIM_H
+#define FLIP_ANIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define FLIP_ANIM_MAGIC "FDAN"
+#define FLIP_ANIM_VERSION 1
+#define FLIP_ANIM_HEADER_SIZE 16
+#define FLIP_ANIM_FRAME_HEADER_SIZE 4
+
+#define FLIP_ANIM_PARTITION_LABEL "anim"
+
+// Changes handed to the driver per flip_dot_apply_changes() call
+#define FLIP_ANIM_CHUNK_CHANGES 64
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    const uint8_t *data;                    // Mapped file, header first
+    size_t size;
+    uint32_t frame_count;
+    esp_partition_mmap_handle_t mmap_handle;
+    bool mapped;                            // mmap_handle is valid
+} flip_anim_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Maps and validates the animation stored in a data partition
+esp_err_t flip_anim_open_partition(flip_anim_t *anim, const char *label);
+
+// Validates an animation already in memory, e.g. embedded in the app image
+esp_err_t flip_anim_open_buffer(flip_anim_t *anim, const uint8_t *data, size_t size);
+
+void flip_anim_close(flip_anim_t *anim);
+
+// Plays the animation loops times, 0 loops forever. Blocks the calling task
+// and paces frames on their stored durations.
+esp_err_t flip_anim_play(const flip_anim_t *anim, flip_dot_t *display, uint32_t loops);
+
+#endif /* FLIP_ANIM_H */
@@ -0,0 +1,361 @@
+/**
+ * @file flip_compositor.c
+ * @brief Layered frame compositor with sprites and dirty rectangle tracking
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "flip_compositor.h"
+#include <string.h>
+#include "esp_log.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_compositor";
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static bool flip_rect_clip(flip_rect_t *rect);
+static bool flip_compositor_image_valid(const flip_sprite_image_t *image);
+static bool flip_compositor_sprite_valid(const flip_compositor_t *comp, int8_t sprite);
+static flip_rect_t flip_rect_union(flip_rect_t a, flip_rect_t b);
+static bool flip_rect_touches(flip_rect_t a, flip_rect_t b);
+static inline uint32_t flip_blend(uint32_t below, uint32_t bits, flip_blend_t blend);
+static uint32_t flip_sprite_row(const flip_sprite_t *sprite, uint8_t row);
+static uint32_t flip_compositor_row(const flip_compositor_t *comp, uint8_t row);
+static void flip_compositor_invalidate_sprite(flip_compositor_t *comp, const flip_sprite_t *sprite);
+static uint16_t flip_compositor_update(flip_compositor_t *comp, flip_dot_t *display);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+// Clips to the panel, returns false when nothing is left
+static bool flip_rect_clip(flip_rect_t *rect) {
+    int16_t x1 = rect->x + rect->width;
+    int16_t y1 = rect->y + rect->height;
+    if (rect->x < 0) {
+        rect->x = 0;
+    }
+    if (rect->y < 0) {
+        rect->y = 0;
+    }
+    if (x1 > DISPLAY_WIDTH) {
+        x1 = DISPLAY_WIDTH;
+    }
+    if (y1 > DISPLAY_HEIGHT) {
+        y1 = DISPLAY_HEIGHT;
+    }
+    rect->width = x1 - rect->x;
+    rect->height = y1 - rect->y;
+    return rect->width > 0 && rect->height > 0;
+}
+
+// Wider rows would not fit the word, and shifting them is undefined
+static bool flip_compositor_image_valid(const flip_sprite_image_t *image) {
+    if (!image) {
+        return false;
+    }
+    if (image->width > FLIP_COMPOSITOR_MAX_SPRITE_WIDTH) {
+        ESP_LOGW(TAG, "Sprite image %d wide, at most %d", image->width, FLIP_COMPOSITOR_MAX_SPRITE_WIDTH);
+        return false;
+    }
+    return true;
+}
+
+static bool flip_compositor_sprite_valid(const flip_compositor_t *comp, int8_t sprite) {
+    return sprite >= 0 && sprite < FLIP_COMPOSITOR_MAX_SPRITES && comp->sprites[sprite].used;
+}
+
+static flip_rect_t flip_rect_union(flip_rect_t a, flip_rect_t b) {
+    int16_t x0 = a.x < b.x ? a.x : b.x;
+    int16_t y0 = a.y < b.y ? a.y : b.y;
+    int16_t x1 = (a.x + a.width > b.x + b.width) ? a.x + a.width : b.x + b.width;
+    int16_t y1 = (a.y + a.height > b.y + b.height) ? a.y + a.height : b.y + b.height;
+    return (flip_rect_t){ .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0 };
+}
+
+// Overlapping or side by side, merging those costs nothing extra
+static bool flip_rect_touches(flip_rect_t a, flip_rect_t b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+static inline uint32_t flip_blend(uint32_t below, uint32_t bits, flip_blend_t blend) {
+    switch (blend) {
+    case FLIP_BLEND_XOR:
+        return below ^ bits;
+    case FLIP_BLEND_MASK:
+        return below & ~bits;
+    case FLIP_BLEND_OR:
+    default:
+        return below | bits;
+    }
+}
+
+// One sprite row shifted to its panel position
+static uint32_t flip_sprite_row(const flip_sprite_t *sprite, uint8_t row) {
+    const flip_sprite_image_t *image = sprite->image;
+    int16_t image_row = row - sprite->y;
+    if (image_row < 0 || image_row >= image->height) {
+        return 0;
+    }
+    if (sprite->x >= DISPLAY_WIDTH || sprite->x <= -(int16_t)image->width) {
+        return 0;
+    }
+
+    // Images are at most 32 wide, so neither shift reaches 32 here
+    uint32_t bits = image->rows[image_row];
+    if (image->width < 32) {
+        bits &= (1UL << image->width) - 1;
+    }
+    bits = sprite->x >= 0 ? bits << sprite->x : bits >> -sprite->x;
+    return bits & FLIP_DOT_ROW_MASK;
+}
+
+// Blends every layer and its sprites for one panel row, bottom up
+static uint32_t flip_compositor_row(const flip_compositor_t *comp, uint8_t row) {
+    uint32_t bits = 0;
+    for (uint8_t l = 0; l < comp->layer_count; l++) {
+        const flip_layer_t *layer = &comp->layers[l];
+        if (layer->visible) {
+            bits = flip_blend(bits, layer->plane.rows[row], layer->blend);
+        }
+        for (uint8_t s = 0; s < FLIP_COMPOSITOR_MAX_SPRITES; s++) {
+            const flip_sprite_t *sprite = &comp->sprites[s];
+            if (sprite->used && sprite->visible && sprite->layer == l) {
+                bits = flip_blend(bits, flip_sprite_row(sprite, row), sprite->blend);
+            }
+        }
+    }
+    return bits & FLIP_DOT_ROW_MASK;
+}
+
+static void flip_compositor_invalidate_sprite(flip_compositor_t *comp, const flip_sprite_t *sprite) {
+    if (!sprite->visible || !sprite->image) {
+        return;
+    }
+    flip_compositor_invalidate(comp, (flip_rect_t){
+        .x = sprite->x, .y = sprite->y, .width = sprite->image->width, .height = sprite->image->height
+    });
+}
+
+// Recomposes the dirty rectangles and diffs them against the output frame.
+// The changed dots go to the display in chunks when one is given.
+static uint16_t flip_compositor_update(flip_compositor_t *comp, flip_dot_t *display) {
+    flip_dot_change_t changes[FLIP_COMPOSITOR_CHUNK_CHANGES];
+    uint16_t count = 0;
+    uint16_t total = 0;
+
+    for (uint8_t i = 0; i < comp->dirty_count; i++) {
+        const flip_rect_t *rect = &comp->dirty[i];
+        uint32_t col_mask = ((1UL << rect->width) - 1) << rect->x;
+
+        for (uint8_t row = rect->y; row < rect->y + rect->height; row++) {
+            uint32_t diff = (flip_compositor_row(comp, row) ^ comp->output.rows[row]) & col_mask;
+            comp->output.rows[row] ^= diff;
+            total += __builtin_popcount(diff);
+
+            while (diff && display) {
+                uint8_t col = __builtin_ctz(diff);
+                diff &= diff - 1;
+                changes[count++] = (flip_dot_change_t){
+                    .row = row, .col = col, .value = (comp->output.rows[row] >> col) & 1
+                };
+                if (count == FLIP_COMPOSITOR_CHUNK_CHANGES) {
+                    flip_dot_apply_changes(display, changes, count);
+                    count = 0;
+                }
+            }
+        }
+    }
+    if (count > 0) {
+        flip_dot_apply_changes(display, changes, count);
+    }
+
+    comp->dirty_count = 0;
+    return total;
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+void flip_compositor_init(flip_compositor_t *comp, uint8_t layer_count) {
+    memset(comp, 0, sizeof(*comp));
+    if (layer_count == 0 || layer_count > FLIP_COMPOSITOR_MAX_LAYERS) {
+        ESP_LOGW(TAG, "%d layers requested, using %d", layer_count, FLIP_COMPOSITOR_MAX_LAYERS);
+        layer_count = FLIP_COMPOSITOR_MAX_LAYERS;
+    }
+    comp->layer_count = layer_count;
+    for (uint8_t l = 0; l < layer_count; l++) {
+        comp->layers[l].blend = FLIP_BLEND_OR;
+        comp->layers[l].visible = true;
+    }
+}
+
+flip_dot_frame_t *flip_compositor_layer_plane(flip_compositor_t *comp, uint8_t layer) {
+    if (layer >= comp->layer_count) {
+        return NULL;
+    }
+    return &comp->layers[layer].plane;
+}
+
+esp_err_t flip_compositor_layer_clear(flip_compositor_t *comp, uint8_t layer) {
+    if (layer >= comp->layer_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flip_dot_frame_clear(&comp->layers[layer].plane);
+    flip_compositor_invalidate_all(comp);
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_layer_set(flip_compositor_t *comp, uint8_t layer, uint8_t row, uint8_t col, bool value) {
+    if (layer >= comp->layer_count || row >= DISPLAY_HEIGHT || col >= DISPLAY_WIDTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (flip_dot_frame_get(&comp->layers[layer].plane, row, col) == value) {
+        return ESP_OK;
+    }
+    flip_dot_frame_set(&comp->layers[layer].plane, row, col, value);
+    flip_compositor_invalidate(comp, (flip_rect_t){ .x = col, .y = row, .width = 1, .height = 1 });
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_set_layer_blend(flip_compositor_t *comp, uint8_t layer, flip_blend_t blend) {
+    if (layer >= comp->layer_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (comp->layers[layer].blend != blend) {
+        comp->layers[layer].blend = blend;
+        flip_compositor_invalidate_all(comp);
+    }
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_show_layer(flip_compositor_t *comp, uint8_t layer, bool visible) {
+    if (layer >= comp->layer_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (comp->layers[layer].visible != visible) {
+        comp->layers[layer].visible = visible;
+        flip_compositor_invalidate_all(comp);
+    }
+    return ESP_OK;
+}
+
+int8_t flip_compositor_add_sprite(flip_compositor_t *comp, const flip_sprite_image_t *image,
+                                  uint8_t layer, flip_blend_t blend) {
+    if (layer >= comp->layer_count || !flip_compositor_image_valid(image)) {
+        return -1;
+    }
+    for (int8_t s = 0; s < FLIP_COMPOSITOR_MAX_SPRITES; s++) {
+        flip_sprite_t *sprite = &comp->sprites[s];
+        if (!sprite->used) {
+            *sprite = (flip_sprite_t){
+                .image = image, .layer = layer, .blend = blend, .visible = false, .used = true
+            };
+            return s;
+        }
+    }
+    ESP_LOGW(TAG, "No sprite slot left");
+    return -1;
+}
+
+esp_err_t flip_compositor_remove_sprite(flip_compositor_t *comp, int8_t sprite) {
+    if (!flip_compositor_sprite_valid(comp, sprite)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flip_compositor_invalidate_sprite(comp, &comp->sprites[sprite]);
+    comp->sprites[sprite].used = false;
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_move_sprite(flip_compositor_t *comp, int8_t sprite, int16_t x, int16_t y) {
+    if (!flip_compositor_sprite_valid(comp, sprite)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flip_sprite_t *s = &comp->sprites[sprite];
+    if (s->x == x && s->y == y) {
+        return ESP_OK;
+    }
+    // Both where it was and where it goes need recomposing
+    flip_compositor_invalidate_sprite(comp, s);
+    s->x = x;
+    s->y = y;
+    flip_compositor_invalidate_sprite(comp, s);
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_show_sprite(flip_compositor_t *comp, int8_t sprite, bool visible) {
+    if (!flip_compositor_sprite_valid(comp, sprite)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flip_sprite_t *s = &comp->sprites[sprite];
+    if (s->visible == visible) {
+        return ESP_OK;
+    }
+    s->visible = true;
+    flip_compositor_invalidate_sprite(comp, s);
+    s->visible = visible;
+    return ESP_OK;
+}
+
+esp_err_t flip_compositor_set_sprite_image(flip_compositor_t *comp, int8_t sprite, const flip_sprite_image_t *image) {
+    if (!flip_compositor_sprite_valid(comp, sprite) || !flip_compositor_image_valid(image)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flip_sprite_t *s = &comp->sprites[sprite];
+    flip_compositor_invalidate_sprite(comp, s);
+    s->image = image;
+    flip_compositor_invalidate_sprite(comp, s);
+    return ESP_OK;
+}
+
+void flip_compositor_invalidate(flip_compositor_t *comp, flip_rect_t rect) {
+    if (!flip_rect_clip(&rect)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < comp->dirty_count; i++) {
+        if (flip_rect_touches(comp->dirty[i], rect)) {
+            comp->dirty[i] = flip_rect_union(comp->dirty[i], rect);
+            return;
+        }
+    }
+    if (comp->dirty_count < FLIP_COMPOSITOR_MAX_DIRTY) {
+        comp->dirty[comp->dirty_count++] = rect;
+        return;
+    }
+
+    // Out of slots, grow the rectangle that gains the least area
+    uint8_t best = 0;
+    int32_t best_growth = INT32_MAX;
+    for (uint8_t i = 0; i < comp->dirty_count; i++) {
+        flip_rect_t merged = flip_rect_union(comp->dirty[i], rect);
+        int32_t growth = (int32_t)merged.width * merged.height - (int32_t)comp->dirty[i].width * comp->dirty[i].height;
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    comp->dirty[best] = flip_rect_union(comp->dirty[best], rect);
+}
+
+void flip_compositor_invalidate_all(flip_compositor_t *comp) {
+    comp->dirty[0] = (flip_rect_t){ .x = 0, .y = 0, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT };
+    comp->dirty_count = 1;
+}
+
+uint16_t flip_compositor_compose(flip_compositor_t *comp) {
+    return flip_compositor_update(comp, NULL);
+}
+
+uint16_t flip_compositor_present(flip_compositor_t *comp, flip_dot_t *display) {
+    return flip_compositor_update(comp, display);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file flip_compositor.h
+ * @brief Layered frame compositor with sprites and dirty rectangle tracking
+ *
+ * Apps draw into bitplane layers and move sprites instead of rebuilding a
+ * whole frame. Layers are blended bottom up, each followed by the sprites
+ * that sit on it:
+ *   OR    sets dots
+ *   XOR   inverts the dots below
+ *   MASK  clears the dots below
+ *
+ * Every change marks a rectangle dirty. flip_compositor_present() only
+ * recomposes the dirty rectangles, diffs them against the last presented
+ * frame and hands the changed dots to flip_dot_apply_changes(), so the cost
+ * follows the size of the change, not the panel.
+ *
+ * Layers and sprites are owned by one producer task, nothing here locks.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_COMPOSITOR_H
+#define FLIP_COMPOSITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define FLIP_COMPOSITOR_MAX_LAYERS 4
+#define FLIP_COMPOSITOR_MAX_SPRITES 8
+
+// A sprite row is one word
+#define FLIP_COMPOSITOR_MAX_SPRITE_WIDTH 32
+
+// Dirty rectangles kept apart before they are merged
+#define FLIP_COMPOSITOR_MAX_DIRTY 4
+
+// Changes handed to the driver per flip_dot_apply_changes() call
+#define FLIP_COMPOSITOR_CHUNK_CHANGES 64
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef enum {
+    FLIP_BLEND_OR = 0,
+    FLIP_BLEND_XOR,
+    FLIP_BLEND_MASK,
+} flip_blend_t;
+
+// x, y may be off the panel, rectangles are clipped when marked dirty
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+} flip_rect_t;
+
+// Sprite bitmap, one word per row with bit c for column c like a packed frame
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    const uint32_t *rows;
+} flip_sprite_image_t;
+
+typedef struct {
+    const flip_sprite_image_t *image;
+    int16_t x;                  // Top left corner, may be off the panel
+    int16_t y;
+    uint8_t layer;              // Drawn right after this layer
+    flip_blend_t blend;
+    bool visible;
+    bool used;
+} flip_sprite_t;
+
+typedef struct {
+    flip_dot_frame_t plane;
+    flip_blend_t blend;
+    bool visible;
+} flip_layer_t;
+
+typedef struct {
+    flip_layer_t layers[FLIP_COMPOSITOR_MAX_LAYERS];
+    uint8_t layer_count;
+    flip_sprite_t sprites[FLIP_COMPOSITOR_MAX_SPRITES];
+    flip_rect_t dirty[FLIP_COMPOSITOR_MAX_DIRTY];
+    uint8_t dirty_count;
+    flip_dot_frame_t output;    // Last presented frame
+} flip_compositor_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Starts from an empty panel, the first present draws everything that differs
+void flip_compositor_init(flip_compositor_t *comp, uint8_t layer_count);
+
+// Direct access to a layer, mark what was drawn with flip_compositor_invalidate().
+// NULL for a layer that does not exist.
+flip_dot_frame_t *flip_compositor_layer_plane(flip_compositor_t *comp, uint8_t layer);
+
+// The layer and sprite calls return ESP_ERR_INVALID_ARG for a layer or
+// sprite id that does not exist, such as the -1 of a failed add
+esp_err_t flip_compositor_layer_clear(flip_compositor_t *comp, uint8_t layer);
+esp_err_t flip_compositor_layer_set(flip_compositor_t *comp, uint8_t layer, uint8_t row, uint8_t col, bool value);
+esp_err_t flip_compositor_set_layer_blend(flip_compositor_t *comp, uint8_t layer, flip_blend_t blend);
+esp_err_t flip_compositor_show_layer(flip_compositor_t *comp, uint8_t layer, bool visible);
+
+// Returns the sprite id, or -1 when every slot is taken, the layer does not
+// exist or the image is wider than FLIP_COMPOSITOR_MAX_SPRITE_WIDTH. Sprites
+// start hidden.
+int8_t flip_compositor_add_sprite(flip_compositor_t *comp, const flip_sprite_image_t *image,
+                                  uint8_t layer, flip_blend_t blend);
+esp_err_t flip_compositor_remove_sprite(flip_compositor_t *comp, int8_t sprite);
+esp_err_t flip_compositor_move_sprite(flip_compositor_t *comp, int8_t sprite, int16_t x, int16_t y);
+esp_err_t flip_compositor_show_sprite(flip_compositor_t *comp, int8_t sprite, bool visible);
+esp_err_t flip_compositor_set_sprite_image(flip_compositor_t *comp, int8_t sprite, const flip_sprite_image_t *image);
+
+void flip_compositor_invalidate(flip_compositor_t *comp, flip_rect_t rect);
+void flip_compositor_invalidate_all(flip_compositor_t *comp);
+
+// Recomposes the dirty rectangles into the output frame, returns the changed dots
+uint16_t flip_compositor_compose(flip_compositor_t *comp);
+
+// Composes and submits the changed dots to the display, returns their number
+uint16_t flip_compositor_present(flip_compositor_t *comp, flip_dot_t *display);
+
+#endif /* FLIP_COMPOSITOR_H */
@@ -8,12 +8,22 @@
 
 #include "flip_dot.h"
 #include <string.h>  
-#include "driver/gpio.h" 
+#include "flip_dot_hal.h"
 #include "freertos/FreeRTOS.h" 
 #include "freertos/task.h"
 #include "esp_log.h"
-#include <math.h>
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_rom_crc.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include <stddef.h>
 #include <stdlib.h>
+#include "fixed_math.h"
+#include "font.h"
+#include "flip_compositor.h"
+#include "trace.h"
 
 /******************************************************************************
  * Private Definitions and Types
@@ -36,6 +46,32 @@
 
 static const char *TAG = "flip_dot";
 
+// Panel state mirror in RTC memory. It survives software resets, panics and
+// brownouts (but not power loss), so boot only has to clear the dots it knows
+// or suspects to be set.
+// One slot per panel, handed out in flip_dot_init() order, which is the same
+// on every boot of the same firmware. Re-initializing a panel keeps its slot.
+typedef struct flip_dot_persist {
+    uint32_t magic;
+    flip_dot_frame_t state;     // Level of every dot as last pulsed
+    flip_dot_frame_t suspect;   // Pulsed since the last settle, may be half flipped
+    uint32_t crc;               // Over everything above
+} flip_dot_persist_t;
+
+#define FLIP_DOT_PERSIST_MAGIC 0x464C4950  // "FLIP"
+
+static RTC_NOINIT_ATTR flip_dot_persist_t s_persist[CONFIG_FLIP_DOT_MAX_PANELS];
+static uint8_t s_persist_owner[CONFIG_FLIP_DOT_MAX_PANELS];  // Coil enable pin + 1 of each slot, 0 when free
+
+// Sine wave demo, 0.3 rad per column and frame, in 1/256ths of an angle unit
+#define SINE_WAVE_ANGLE_STEP_Q8 12516
+
+// Ripple demo, ring half width in 1/256 dots (0.8 dots)
+#define RIPPLE_RING_HALF_WIDTH 205
+
+// Game of Life, generations kept to spot boards stuck in a short cycle
+#define LIFE_HISTORY_LEN 16
+
 /******************************************************************************
  * Private Function Declarations
  ******************************************************************************/
@@ -75,18 +111,479 @@ void demux_74HC139_disable_output(demux_74HC139_t *demux, uint8_t channel);
 /******************************************************************************
  * Private Function Implementations
  ******************************************************************************/
-// Delay function (microseconds)
-static void delay_us(uint32_t us) {
-    // Replace with your platform's microsecond delay
-    uint32_t delay_ms = us / 1000; // Convert to milliseconds
-    //ESP_LOGI(TAG, "Delaying for %ld milliseconds", delay_ms);
-    vTaskDelay(delay_ms / portTICK_PERIOD_MS);
+// Slot of the panel with this coil enable pin, or the first free one
+static flip_dot_persist_t *flip_dot_persist_claim(uint8_t enable_pin) {
+    for (uint8_t i = 0; i < CONFIG_FLIP_DOT_MAX_PANELS; i++) {
+        if (s_persist_owner[i] == enable_pin + 1) {
+            return &s_persist[i];
+        }
+    }
+    for (uint8_t i = 0; i < CONFIG_FLIP_DOT_MAX_PANELS; i++) {
+        if (s_persist_owner[i] == 0) {
+            s_persist_owner[i] = enable_pin + 1;
+            return &s_persist[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t flip_dot_persist_crc(const flip_dot_persist_t *persist) {
+    return esp_rom_crc32_le(0, (const uint8_t *)persist, offsetof(flip_dot_persist_t, crc));
+}
+
+// Records a dot before it is pulsed, it stays suspect until the pulse is done
+static void flip_dot_persist_mark(flip_dot_t *display, uint8_t row, uint8_t col, bool value) {
+    flip_dot_persist_t *persist = display->persist;
+    if (!persist) {
+        return;
+    }
+    persist->magic = FLIP_DOT_PERSIST_MAGIC;
+    flip_dot_frame_set(&persist->state, row, col, value);
+    flip_dot_frame_set(&persist->suspect, row, col, true);
+    persist->crc = flip_dot_persist_crc(persist);
+}
+
+// All pulses are done, the mirror now matches the panel
+static void flip_dot_persist_settle(flip_dot_t *display) {
+    flip_dot_persist_t *persist = display->persist;
+    if (!persist) {
+        return;
+    }
+    bool any = false;
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        any |= persist->suspect.rows[r] != 0;
+        persist->suspect.rows[r] = 0;
+    }
+    if (any) {
+        persist->crc = flip_dot_persist_crc(persist);
+    }
+}
+
+static bool flip_dot_persist_valid(const flip_dot_t *display) {
+    const flip_dot_persist_t *persist = display->persist;
+    if (!persist) {
+        return false;
+    }
+    // RTC memory holds garbage after power-on, the panel may show anything
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_UNKNOWN) {
+        return false;
+    }
+    return persist->magic == FLIP_DOT_PERSIST_MAGIC && persist->crc == flip_dot_persist_crc(persist);
+}
+
+// Waits for the pulse chain to finish and settles the RTC mirror. The supply
+// may be gated off from here on.
+static void flip_dot_wait_idle(flip_dot_t *display) {
+    pulse_engine_wait_idle(&display->pulse_engine);
+    flip_dot_persist_settle(display);
+    if (display->supply_held) {
+        flip_dot_supply_gate_release(display->supply_gate);
+        display->supply_held = false;
+    }
+}
+
+// Holds the flip board on for the pulses to come. A failed power-up is latched
+// for FLIP_DOT_SUPPLY_RETRY_MS, so the rest of the update fails at once
+// instead of powering up again for every dot.
+static esp_err_t flip_dot_hold_supply(flip_dot_t *display) {
+    if (!display->supply_gate || display->supply_held) {
+        return ESP_OK;
+    }
+    if (display->supply_retry_us && esp_timer_get_time() < display->supply_retry_us) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = flip_dot_supply_gate_acquire(display->supply_gate);
+    if (ret != ESP_OK) {
+        display->supply_retry_us = esp_timer_get_time() + FLIP_DOT_SUPPLY_RETRY_MS * 1000LL;
+        return ret;
+    }
+    display->supply_retry_us = 0;
+    display->supply_held = true;
+    return ESP_OK;
+}
+
+// Everything a pulse needs from the supply side: a switched on flip board and
+// room in the energy budget. Fails when the board supply did not come up.
+static esp_err_t flip_dot_prepare_supply(flip_dot_t *display) {
+    esp_err_t ret = flip_dot_hold_supply(display);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!display->energy_budget) {
+        return ESP_OK;
+    }
+    
+    uint32_t wait_us = flip_dot_energy_budget_take(display->energy_budget, display->flip_time_us);
+    if (wait_us == 0) {
+        return ESP_OK;
+    }
+    int64_t start_us = esp_timer_get_time();
+    do {
+        uint32_t ticks = wait_us / (portTICK_PERIOD_MS * 1000);
+        if (ticks > 0) {
+            vTaskDelay(ticks);
+        } else {
+            flip_dot_hal_delay_us(wait_us);
+        }
+    } while ((wait_us = flip_dot_energy_budget_take(display->energy_budget, display->flip_time_us)) > 0);
+    FLIP_DOT_STAT(display->stats.energy_wait_us += esp_timer_get_time() - start_us);
+    return ESP_OK;
+}
+
+// Adds a pin to an address word, considering inversion
+static void gpio_word_add_pin(flip_dot_gpio_word_t *levels, flip_dot_gpio_word_t *mask, gpio_pin_t pin, bool value) {
+    if (pin.pin == 0xFF) { // 0xFF indicates unused pin
+        return;
+    }
+    uint8_t bank = pin.pin / 32;
+    uint32_t bit = 1UL << (pin.pin % 32);
+    mask->bank[bank] |= bit;
+    if (pin.is_inverted ? !value : value) {
+        levels->bank[bank] |= bit;
+    }
+}
+
+// Precomputes the GPIO levels of every row and column address. Row and column
+// words drive disjoint pins, so a pixel address is simply row | col.
+static void flip_dot_build_address_tables(flip_dot_t *display) {
+    demux_74HC139_t *enable = &display->enable_demux;
+    memset(&display->addr_mask, 0, sizeof(display->addr_mask));
+    memset(display->row_addr, 0, sizeof(display->row_addr));
+    memset(display->col_addr, 0, sizeof(display->col_addr));
+
+    for (uint8_t value = 0; value < 2; value++) {
+        for (uint8_t row = 0; row < DISPLAY_HEIGHT; row++) {
+            uint8_t grp = row / 7;
+            uint8_t pos = row % 7 + 1 + ((!value) * 8);
+            flip_dot_gpio_word_t *word = &display->row_addr[value][row];
+            gpio_word_add_pin(word, &display->addr_mask, enable->pin_1A0, grp & 0x01);
+            gpio_word_add_pin(word, &display->addr_mask, enable->pin_1A1, grp & 0x02);
+            gpio_word_add_pin(word, &display->addr_mask, display->row_demux.pin_A0, pos & 0x01);
+            gpio_word_add_pin(word, &display->addr_mask, display->row_demux.pin_A1, pos & 0x02);
+            gpio_word_add_pin(word, &display->addr_mask, display->row_demux.pin_A2, pos & 0x04);
+            gpio_word_add_pin(word, &display->addr_mask, display->row_demux.pin_A3, !(pos & 0x08)); // A3 is inverted in the original code
+        }
+        for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
+            uint8_t grp = col / 7;
+            uint8_t pos = col % 7 + 1 + ((!value) * 8);
+            flip_dot_gpio_word_t *word = &display->col_addr[value][col];
+            gpio_word_add_pin(word, &display->addr_mask, enable->pin_2A0, grp & 0x01);
+            gpio_word_add_pin(word, &display->addr_mask, enable->pin_2A1, grp & 0x02);
+            gpio_word_add_pin(word, &display->addr_mask, display->col_demux.pin_A0, pos & 0x01);
+            gpio_word_add_pin(word, &display->addr_mask, display->col_demux.pin_A1, pos & 0x02);
+            gpio_word_add_pin(word, &display->addr_mask, display->col_demux.pin_A2, pos & 0x04);
+            gpio_word_add_pin(word, &display->addr_mask, display->col_demux.pin_A3, !(pos & 0x08)); // A3 is inverted in the original code
+        }
+    }
+}
+
+// Applies a full pixel address with one W1TC and one W1TS write per GPIO bank,
+// touching only the lines that differ from what is already driven. 2E is
+// released while this runs, so the short half-set state between the two
+// writes never reaches a coil.
+static inline void flip_dot_write_address(flip_dot_t *display, uint8_t row, uint8_t col, bool value) {
+    const flip_dot_gpio_word_t *row_word = &display->row_addr[value][row];
+    const flip_dot_gpio_word_t *col_word = &display->col_addr[value][col];
+
+    uint32_t levels = row_word->bank[0] | col_word->bank[0];
+    uint32_t changed = display->addr_state_valid ? (levels ^ display->addr_state.bank[0]) & display->addr_mask.bank[0]
+                                                 : display->addr_mask.bank[0];
+    if (changed) {
+        flip_dot_hal_bank_write(0, changed & levels, changed & ~levels);
+        display->addr_state.bank[0] = levels;
+    }
+
+    levels = row_word->bank[1] | col_word->bank[1];
+    changed = display->addr_state_valid ? (levels ^ display->addr_state.bank[1]) & display->addr_mask.bank[1]
+                                        : display->addr_mask.bank[1];
+    if (changed) {
+        flip_dot_hal_bank_write(1, changed & levels, changed & ~levels);
+        display->addr_state.bank[1] = levels;
+    }
+
+    display->addr_state_valid = true;
+}
+
+// Address write, with its CPU time booked into the stats
+static inline void flip_dot_write_address_timed(flip_dot_t *display, uint8_t row, uint8_t col, bool value) {
+#if CONFIG_FLIP_DOT_STATS
+    uint32_t start = esp_cpu_get_cycle_count();
+    flip_dot_write_address(display, row, col, value);
+    display->stats.address_cycles += esp_cpu_get_cycle_count() - start;
+#else
+    flip_dot_write_address(display, row, col, value);
+#endif
+}
+
+// Flips one pixel towards the target frame, unless the update budget is spent
+// or the flip board supply is down. The first flip of an update always goes
+// ahead, so a deadline shorter than one pulse still makes progress.
+static bool flip_dot_flip_budgeted(flip_dot_t *display, uint8_t row, uint8_t col) {
+    if (flip_dot_hold_supply(display) != ESP_OK) {
+        return false;
+    }
+    if (display->budget_flips_done > 0) {
+        if (display->flip_budget && display->budget_flips_done >= display->flip_budget) {
+            return false;
+        }
+        if (display->flip_deadline_us &&
+            esp_timer_get_time() + display->flip_time_us + display->recovery_time_us > display->budget_deadline_us) {
+            return false;
+        }
+    }
+    display->budget_flips_done++;
+    flip_dot_set_pixel(display, row, col, flip_dot_frame_get(&display->target, row, col));
+    return true;
+}
+
+// Flips the dirty pixels in the order of the display's sweep table, starting at
+// the sweep cursor and stopping as soon as the last dirty pixel has been
+// reached. Returns false if the budget ran out, the cursor then points at the
+// first pixel that was not flipped.
+static bool flip_dot_flip_in_order(flip_dot_t *display, const flip_dot_frame_t *dirty, uint16_t flip_count) {
+    uint16_t i = display->sweep_cursor;
+    for (uint16_t n = 0; n < DISPLAY_PIXEL_COUNT && flip_count > 0; n++) {
+        uint8_t r = display->sweep_order[i] >> 8;
+        uint8_t c = display->sweep_order[i] & 0xFF;
+        if ((dirty->rows[r] >> c) & 1) {
+            if (!flip_dot_flip_budgeted(display, r, c)) {
+                display->sweep_cursor = i;
+                return false;
+            }
+            flip_count--;
+        }
+        if (++i == DISPLAY_PIXEL_COUNT) {
+            i = 0;
+        }
+    }
+    return true;
+}
+
+// Row order without the table, walking the set bits of each dirty word. The
+// row table index is row * DISPLAY_WIDTH + col, so the cursor is shared.
+static bool flip_dot_flip_rows(flip_dot_t *display, const flip_dot_frame_t *dirty) {
+    uint8_t start_row = display->sweep_cursor / DISPLAY_WIDTH;
+    uint32_t start_bits = ~0UL << (display->sweep_cursor % DISPLAY_WIDTH);
+    
+    // One extra pass over the start row for the columns before the cursor
+    for (uint8_t k = 0; k <= DISPLAY_HEIGHT; k++) {
+        uint8_t r = (start_row + k) % DISPLAY_HEIGHT;
+        uint32_t bits = dirty->rows[r];
+        if (k == 0) {
+            bits &= start_bits;
+        } else if (k == DISPLAY_HEIGHT) {
+            bits &= ~start_bits;
+        }
+        while (bits) {
+            uint8_t c = __builtin_ctz(bits);
+            if (!flip_dot_flip_budgeted(display, r, c)) {
+                display->sweep_cursor = r * DISPLAY_WIDTH + c;
+                return false;
+            }
+            bits &= bits - 1;
+        }
+    }
+    return true;
+}
+
+// Flips the dirty pixels turning on, then the ones turning off. Set and clear
+// use different demux output banks, so this switches the bank once per frame.
+static bool flip_dot_flip_by_value(flip_dot_t *display, const flip_dot_frame_t *dirty) {
+    for (uint8_t value = 2; value-- > 0;) {
+        flip_dot_frame_t subset;
+        uint16_t count = 0;
+        for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+            subset.rows[r] = dirty->rows[r] & (value ? display->target.rows[r] : ~display->target.rows[r]);
+            count += __builtin_popcount(subset.rows[r]);
+        }
+        if (!flip_dot_flip_in_order(display, &subset, count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Linear interpolation on the calibration curve, clamped to its end points
+static void flip_dot_interpolate_timing(const flip_dot_adaptive_timing_t *adaptive, int mv,
+                                        uint32_t *flip_time_us, uint32_t *recovery_time_us) {
+    const flip_dot_timing_point_t *curve = adaptive->curve;
+    uint8_t last = adaptive->curve_len - 1;
+    
+    if (mv <= curve[0].supply_mv) {
+        *flip_time_us = curve[0].flip_time_us;
+        *recovery_time_us = curve[0].recovery_time_us;
+        return;
+    }
+    if (mv >= curve[last].supply_mv) {
+        *flip_time_us = curve[last].flip_time_us;
+        *recovery_time_us = curve[last].recovery_time_us;
+        return;
+    }
+    
+    uint8_t i = 1;
+    while (curve[i].supply_mv < mv) {
+        i++;
+    }
+    const flip_dot_timing_point_t *lo = &curve[i - 1];
+    const flip_dot_timing_point_t *hi = &curve[i];
+    int32_t span = hi->supply_mv - lo->supply_mv;
+    int32_t pos = mv - lo->supply_mv;
+    *flip_time_us = lo->flip_time_us + ((int32_t)(hi->flip_time_us - lo->flip_time_us) * pos) / span;
+    *recovery_time_us = lo->recovery_time_us + ((int32_t)(hi->recovery_time_us - lo->recovery_time_us) * pos) / span;
+}
+
+// Re-reads the supply and rescales the pulse timing once the sample period is up
+static void flip_dot_update_adaptive_timing(flip_dot_t *display) {
+    flip_dot_adaptive_timing_t *adaptive = &display->adaptive;
+    if (!adaptive->read_voltage) {
+        return;
+    }
+    
+    int64_t now = esp_timer_get_time();
+    if (now < adaptive->next_sample_us) {
+        return;
+    }
+    adaptive->next_sample_us = now + adaptive->period_us;
+    
+    int mv;
+    if (adaptive->read_voltage(&mv) != ESP_OK) {
+        ESP_LOGW(TAG, "Supply voltage unavailable, keeping %ld us pulse", display->flip_time_us);
+        return;
+    }
+    adaptive->last_mv = mv;
+    flip_dot_interpolate_timing(adaptive, mv, &display->flip_time_us, &display->recovery_time_us);
+    TRACE(FLIP_TIMING, mv, TRACE_PACK(display->flip_time_us, display->recovery_time_us));
+}
+
+// Books a fully drawn frame into the stats
+static void flip_dot_close_frame(flip_dot_t *display) {
+#if CONFIG_FLIP_DOT_STATS
+    if (!display->frame_open) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    flip_dot_stats_t *stats = &display->stats;
+    
+    display->frame_open = false;
+    stats->frames++;
+    stats->last_flips = display->frame_flips;
+    if (display->frame_flips > stats->max_flips) {
+        stats->max_flips = display->frame_flips;
+    }
+    stats->last_frame_us = now - display->frame_start_us;
+    TRACE(FLIP_FRAME_DONE, display->frame_flips, stats->last_frame_us);
+    stats->last_latency_us = now - display->frame_submit_us;
+    if (stats->last_latency_us > stats->max_latency_us) {
+        stats->max_latency_us = stats->last_latency_us;
+    }
+#endif
+}
+
+// Computes the dirty set, pixel_state XOR target, and returns its size
+static uint16_t flip_dot_get_dirty(const flip_dot_t *display, flip_dot_frame_t *dirty) {
+    uint16_t count = 0;
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        dirty->rows[r] = (display->target.rows[r] ^ display->pixel_state.rows[r]) & FLIP_DOT_ROW_MASK;
+        count += __builtin_popcount(dirty->rows[r]);
+    }
+    return count;
+}
+
+// The new frame replaces the target. Dots still waiting from the previous
+// frame keep their place, dots that reverted drop out of the dirty set.
+static void flip_dot_open_frame(flip_dot_t *display, const flip_dot_frame_t *frame, int64_t submit_us) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        display->target.rows[r] = frame->rows[r] & FLIP_DOT_ROW_MASK;
+    }
+    
+#if CONFIG_FLIP_DOT_STATS
+    flip_dot_frame_t dirty;
+    uint16_t dirty_count = flip_dot_get_dirty(display, &dirty);
+    if (display->frame_open) {
+        display->stats.frames_superseded++;
+    }
+    display->frame_open = true;
+    display->frame_flips = 0;
+    display->frame_start_us = esp_timer_get_time();
+    display->frame_submit_us = submit_us;
+    display->stats.last_dirty = dirty_count;
+    TRACE(FLIP_FRAME_OPEN, dirty_count, 0);
+    if (dirty_count > display->stats.max_dirty) {
+        display->stats.max_dirty = dirty_count;
+    }
+#endif
+}
+
+// Rotates a packed row by one column, wrapping around the panel edge
+static inline uint32_t life_rotate_left(uint32_t row) {
+    return ((row << 1) | (row >> (DISPLAY_WIDTH - 1))) & FLIP_DOT_ROW_MASK;
+}
+
+static inline uint32_t life_rotate_right(uint32_t row) {
+    return ((row >> 1) | (row << (DISPLAY_WIDTH - 1))) & FLIP_DOT_ROW_MASK;
+}
+
+// One Game of Life generation on a torus, a whole row per step. The eight
+// neighbour bits of every cell are summed in parallel with full adders: the
+// ones bit of the count, plus the number of pairs. A cell lives on with a
+// count of 2 or 3, i.e. exactly one pair, and the ones bit or the cell set.
+static void life_step(const flip_dot_frame_t *current, flip_dot_frame_t *next) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        uint32_t up = current->rows[r == 0 ? DISPLAY_HEIGHT - 1 : r - 1];
+        uint32_t mid = current->rows[r];
+        uint32_t down = current->rows[r == DISPLAY_HEIGHT - 1 ? 0 : r + 1];
+        
+        // Row above and below, three neighbours each
+        uint32_t a = life_rotate_left(up), c = life_rotate_right(up);
+        uint32_t up_ones = a ^ up ^ c;
+        uint32_t up_twos = (a & up) | (c & (a ^ up));
+        uint32_t f = life_rotate_left(down), h = life_rotate_right(down);
+        uint32_t down_ones = f ^ down ^ h;
+        uint32_t down_twos = (f & down) | (h & (f ^ down));
+        
+        // Same row, two neighbours
+        uint32_t d = life_rotate_left(mid), e = life_rotate_right(mid);
+        uint32_t mid_ones = d ^ e;
+        uint32_t mid_twos = d & e;
+        
+        // Add up the ones, the carry is one more pair
+        uint32_t ones = up_ones ^ mid_ones ^ down_ones;
+        uint32_t carry = (up_ones & mid_ones) | (down_ones & (up_ones ^ mid_ones));
+        
+        // Exactly one of the four pair bits set
+        uint32_t x1 = up_twos ^ mid_twos, x2 = down_twos ^ carry;
+        uint32_t one_pair = (x1 ^ x2) & ~((up_twos & mid_twos) | (down_twos & carry));
+        
+        next->rows[r] = one_pair & (ones | mid);
+    }
+}
+
+// Fills about a third of the board
+static void life_seed(flip_dot_frame_t *board) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        board->rows[r] = 0;
+        for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
+            if (rand() % 3 == 0) {
+                board->rows[r] |= 1UL << c;
+            }
+        }
+    }
 }
 
-// Delay function (milliseconds)
-static void delay_ms(uint32_t ms) {
-    // Replace with your platform's millisecond delay
-    vTaskDelay(ms / portTICK_PERIOD_MS);
+static bool life_frame_equal(const flip_dot_frame_t *a, const flip_dot_frame_t *b) {
+    return memcmp(a->rows, b->rows, sizeof(a->rows)) == 0;
+}
+
+// Shuffles a sweep table in place (Fisher-Yates)
+static void shuffle_sweep_order(uint16_t order[DISPLAY_PIXEL_COUNT]) {
+    for (uint16_t i = DISPLAY_PIXEL_COUNT - 1; i > 0; i--) {
+        uint16_t j = rand() % (i + 1);
+        uint16_t temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
 }
 
 // Converts a decimal number to binary array
@@ -107,7 +604,7 @@ static void decimal_to_bin(uint8_t number, uint8_t bits, uint8_t *binary_arr) {
 
 void gpio_write(uint8_t pin, bool value, bool is_inverted) {
     // Write value to GPIO pin, considering inversion
-    gpio_set_level(pin, is_inverted ? !value : value);
+    flip_dot_hal_gpio_write(pin, is_inverted ? !value : value);
 }
 
 /******************************************************************************
@@ -125,19 +622,13 @@ void demux_74HC4514_init(demux_74HC4514_t *demux,
     demux->pin_A3 = pin_A3;
 
     //Initiaze GPIOs
-    gpio_config_t io_config = {   
-        .pin_bit_mask = (1ULL << pin_A0.pin) | (1ULL << pin_A1.pin) | (1ULL << pin_A2.pin),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
+    uint64_t pin_mask = (1ULL << pin_A0.pin) | (1ULL << pin_A1.pin) | (1ULL << pin_A2.pin);
     
     if (pin_A3.pin != 0xFF) { // 0xFF indicates unused pin
-        io_config.pin_bit_mask |= (1ULL << pin_A3.pin);
+        pin_mask |= (1ULL << pin_A3.pin);
     }
 
-    gpio_config(&io_config);
+    flip_dot_hal_config_outputs(pin_mask);
 
 }
 
@@ -147,18 +638,15 @@ void demux_74HC4514_set_output(demux_74HC4514_t *demux, uint8_t output_pos) {
     // Convert output position to binary
     decimal_to_bin(output_pos, 4, binary);
     
-    ESP_LOGD(TAG, "74HC4514 output_pos=%d -> binary=[%d,%d,%d,%d]", output_pos, binary[0], binary[1], binary[2], binary[3]);
+    TRACE(DEMUX_4514, output_pos, 0);
     
     // Set output pins
     gpio_write(demux->pin_A0.pin, binary[3], demux->pin_A0.is_inverted);
     gpio_write(demux->pin_A1.pin, binary[2], demux->pin_A1.is_inverted);
     gpio_write(demux->pin_A2.pin, binary[1], demux->pin_A2.is_inverted);
     
-    ESP_LOGD(TAG, "Setting pins: A0=%d, A1=%d, A2=%d", binary[3], binary[2], binary[1]);
-    
     if (demux->pin_A3.pin != 0xFF) {
         gpio_write(demux->pin_A3.pin, !binary[0], demux->pin_A3.is_inverted); // A3 is inverted in the original code
-        ESP_LOGD(TAG, "Setting pin A3=%d (inverted from %d)", !binary[0], binary[0]);
     }
 }
 
@@ -177,14 +665,7 @@ void demux_74HC139_init(demux_74HC139_t *demux,
     demux->pin_2E = pin_2E;
     
     //Initiaze GPIOs
-    gpio_config_t io_config = {   
-        .pin_bit_mask = (1ULL << pin_1A0.pin) | (1ULL << pin_1A1.pin) | (1ULL << pin_2A0.pin) | (1ULL << pin_2A1.pin) | (1ULL << pin_1E.pin) | (1ULL << pin_2E.pin),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&io_config);
+    flip_dot_hal_config_outputs((1ULL << pin_1A0.pin) | (1ULL << pin_1A1.pin) | (1ULL << pin_2A0.pin) | (1ULL << pin_2A1.pin) | (1ULL << pin_1E.pin) | (1ULL << pin_2E.pin));
 }
 
 void demux_74HC139_set_row_output(demux_74HC139_t *demux, 
@@ -196,16 +677,13 @@ void demux_74HC139_set_row_output(demux_74HC139_t *demux,
     // Convert row group to binary
     decimal_to_bin(row_grp, 2, binary);
     
-    ESP_LOGD(TAG, "74HC139 ROW: row_grp=%d -> binary=[%d,%d]", row_grp, binary[0], binary[1]);
+    TRACE(DEMUX_139_ROW, output_pos, row_grp);
     
     // Set row group pins
     gpio_write(demux->pin_1A0.pin, binary[1], demux->pin_1A0.is_inverted);
     gpio_write(demux->pin_1A1.pin, binary[0], demux->pin_1A1.is_inverted);
     
-    ESP_LOGD(TAG, "Setting row group pins: 1A0=%d, 1A1=%d", binary[1], binary[0]);
-    
     // Set row output position
-    ESP_LOGD(TAG, "Setting ROW demux for output_pos=%d", output_pos);
     demux_74HC4514_set_output(row_demux, output_pos);
 }
 
@@ -218,16 +696,13 @@ void demux_74HC139_set_col_output(demux_74HC139_t *demux,
     // Convert column group to binary
     decimal_to_bin(col_grp, 2, binary);
     
-    ESP_LOGD(TAG, "74HC139 COL: col_grp=%d -> binary=[%d,%d]", col_grp, binary[0], binary[1]);
+    TRACE(DEMUX_139_COL, output_pos, col_grp);
     
     // Set column group pins
     gpio_write(demux->pin_2A0.pin, binary[1], demux->pin_2A0.is_inverted);
     gpio_write(demux->pin_2A1.pin, binary[0], demux->pin_2A1.is_inverted);
     
-    ESP_LOGD(TAG, "Setting col group pins: 2A0=%d, 2A1=%d", binary[1], binary[0]);
-    
     // Set column output position
-    ESP_LOGD(TAG, "Setting COL demux for output_pos=%d", output_pos);
     demux_74HC4514_set_output(col_demux, output_pos);
 }
 
@@ -253,31 +728,54 @@ void demux_74HC139_disable_output(demux_74HC139_t *demux, uint8_t channel) {
 }
 
 
+flip_dot_pins_t flip_dot_get_default_pins(void) {
+    flip_dot_pins_t pins = {
+        .row_A0 = {PIN_ROW_A0, false},
+        .row_A1 = {PIN_ROW_A1, false},
+        .row_A2 = {PIN_ROW_A2, false},
+        .row_A3 = {0xFF, false},  // Not used for rows
+        
+        .col_A0 = {PIN_COL_A0, false},
+        .col_A1 = {PIN_COL_A1, false},
+        .col_A2 = {PIN_COL_A2, false},
+        .col_A3 = {PIN_COL_A3, true},
+        
+        .enable_1A0 = {PIN_ENABLE_1A0, false},
+        .enable_1A1 = {PIN_ENABLE_1A1, false},
+        .enable_2A0 = {PIN_ENABLE_2A0, false},
+        .enable_2A1 = {PIN_ENABLE_2A1, false},
+        .enable_1E = {PIN_ENABLE_1E, false},
+        .enable_2E = {PIN_ENABLE_2E, false},
+    };
+    return pins;
+}
+
+uint64_t flip_dot_pins_mask(const flip_dot_pins_t *pins) {
+    const gpio_pin_t *list = &pins->row_A0;
+    uint64_t mask = 0;
+    for (size_t i = 0; i < sizeof(*pins) / sizeof(gpio_pin_t); i++) {
+        if (list[i].pin != 0xFF) {
+            mask |= 1ULL << list[i].pin;
+        }
+    }
+    return mask;
+}
+
 void flip_dot_init(flip_dot_t *display, uint32_t flip_time_us, sweep_mode_t sweep_mode) {
+    flip_dot_pins_t pins = flip_dot_get_default_pins();
+    flip_dot_init_with_pins(display, &pins, flip_time_us, sweep_mode);
+}
+
+void flip_dot_init_with_pins(flip_dot_t *display, const flip_dot_pins_t *pins, uint32_t flip_time_us, sweep_mode_t sweep_mode) {
     
     ESP_LOGI(TAG, "Initializing flip dot");
-    // Setup pin configurations
-    gpio_pin_t row_A0 = {PIN_ROW_A0, false};
-    gpio_pin_t row_A1 = {PIN_ROW_A1, false};
-    gpio_pin_t row_A2 = {PIN_ROW_A2, false};
-    gpio_pin_t row_A3 = {0xFF, false};  // Not used for rows
-    
-    gpio_pin_t col_A0 = {PIN_COL_A0, false};
-    gpio_pin_t col_A1 = {PIN_COL_A1, false};
-    gpio_pin_t col_A2 = {PIN_COL_A2, false};
-    gpio_pin_t col_A3 = {PIN_COL_A3, true};
-    
-    gpio_pin_t enable_1A0 = {PIN_ENABLE_1A0, false};
-    gpio_pin_t enable_1A1 = {PIN_ENABLE_1A1, false};
-    gpio_pin_t enable_2A0 = {PIN_ENABLE_2A0, false};
-    gpio_pin_t enable_2A1 = {PIN_ENABLE_2A1, false};
-    gpio_pin_t enable_1E = {PIN_ENABLE_1E, false};
-    gpio_pin_t enable_2E = {PIN_ENABLE_2E, false};  
+    gpio_pin_t enable_2E = pins->enable_2E;
     
     // Initialize demuxes
-    demux_74HC4514_init(&display->row_demux, row_A0, row_A1, row_A2, row_A3);
-    demux_74HC4514_init(&display->col_demux, col_A0, col_A1, col_A2, col_A3);
-    demux_74HC139_init(&display->enable_demux, enable_1A0, enable_1A1, enable_2A0, enable_2A1, enable_1E, enable_2E);
+    demux_74HC4514_init(&display->row_demux, pins->row_A0, pins->row_A1, pins->row_A2, pins->row_A3);
+    demux_74HC4514_init(&display->col_demux, pins->col_A0, pins->col_A1, pins->col_A2, pins->col_A3);
+    demux_74HC139_init(&display->enable_demux, pins->enable_1A0, pins->enable_1A1, pins->enable_2A0, pins->enable_2A1,
+                       pins->enable_1E, pins->enable_2E);
     
     // gpio_pin_t pins_to_flip[] = {enable_1E, enable_1A0, enable_1A1, enable_2A0, enable_2A1, col_A0, col_A1, col_A2, col_A3, row_A0, row_A1, row_A2, row_A3};
 
@@ -299,126 +797,493 @@ void flip_dot_init(flip_dot_t *display, uint32_t flip_time_us, sweep_mode_t swee
 
     // Set parameters
     display->flip_time_us = flip_time_us;
-    display->sweep_mode = sweep_mode;
+    display->recovery_time_us = FLIP_DOT_DEFAULT_RECOVERY_US;
+    flip_dot_set_sweep_mode(display, sweep_mode);
+    display->renderer.task = NULL;
+
+    // RTC mirror slot, panels past CONFIG_FLIP_DOT_MAX_PANELS always get a full clear
+    display->persist = flip_dot_persist_claim(enable_2E.pin);
+    if (!display->persist) {
+        ESP_LOGW(TAG, "No RTC state slot left for the panel on GPIO%d", enable_2E.pin);
+    }
+
+    // Precompute the address pin levels of every pixel
+    flip_dot_build_address_tables(display);
+    display->addr_state_valid = false;
+
+    // Coil pulses are timed by the pulse engine, it falls back to software timing on error
+    pulse_engine_init(&display->pulse_engine, enable_2E.pin, enable_2E.is_inverted);
     
     // Initialize pixel state to all zeros
-    memset(display->pixel_state, 0, sizeof(display->pixel_state));
+    flip_dot_frame_clear(&display->pixel_state);
+    flip_dot_frame_clear(&display->target);
+    display->sweep_cursor = 0;
+    display->flip_budget = 0;
+    display->flip_deadline_us = 0;
+    display->pipelined = false;
+    display->adaptive.read_voltage = NULL;
+    display->frame_open = false;
+    display->energy_budget = NULL;
+    display->supply_gate = NULL;
+    display->supply_held = false;
+    display->supply_retry_us = 0;
+    flip_dot_reset_stats(display);
     
-    // Enable row output
+    // Enable row output. These are static logic levels, the wait for the
+    // panel supply happens in pwr_ctrl once the board is switched on.
     demux_74HC139_enable_output(&display->enable_demux, 1);
     gpio_write(enable_2E.pin, false, enable_2E.is_inverted);
-    delay_ms(200);
+}
+
+// Shares a pulse token pool with other panels, see pulse_engine_set_power_tokens()
+void flip_dot_set_power_tokens(flip_dot_t *display, SemaphoreHandle_t tokens) {
+    flip_dot_wait_idle(display);
+    pulse_engine_set_power_tokens(&display->pulse_engine, tokens);
+}
+
+// Budgets and gates can be shared by several panels on the same supply
+void flip_dot_set_energy_budget(flip_dot_t *display, flip_dot_energy_budget_t *budget) {
+    flip_dot_wait_idle(display);
+    display->energy_budget = budget;
+}
+
+void flip_dot_set_supply_gate(flip_dot_t *display, flip_dot_supply_gate_t *gate) {
+    flip_dot_wait_idle(display);
+    display->supply_gate = gate;
+}
+
+void flip_dot_set_timing(flip_dot_t *display, uint32_t flip_time_us, uint32_t recovery_time_us) {
+    display->flip_time_us = flip_time_us;
+    display->recovery_time_us = recovery_time_us;
+    ESP_LOGI(TAG, "Pulse timing set to %ld us pulse, %ld us recovery", flip_time_us, recovery_time_us);
+}
+
+// Switches the flip order. Rebuilds the sweep table, so call it before the
+// render task starts or between frames.
+void flip_dot_set_sweep_mode(flip_dot_t *display, sweep_mode_t sweep_mode) {
+    if (sweep_mode >= SWEEP_MODE_COUNT) {
+        ESP_LOGW(TAG, "Unknown sweep mode %d, using row order", sweep_mode);
+        sweep_mode = SWEEP_ROW;
+    }
+    display->sweep_mode = sweep_mode;
+    flip_dot_build_sweep_order(sweep_mode, display->sweep_order);
+}
+
+void flip_dot_build_sweep_order(sweep_mode_t sweep_mode, uint16_t order[DISPLAY_PIXEL_COUNT]) {
+    // Pixel index within a 7-pixel group in 3-bit Gray code order of its
+    // demux output (pixel + 1), and 2-bit Gray code order of the group selects
+    static const uint8_t gray_pixel[7] = {0, 2, 1, 5, 6, 4, 3};
+    static const uint8_t gray_group[4] = {0, 1, 3, 2};
+    uint16_t n = 0;
     
-    delay_ms(200);
+    switch (sweep_mode) {
+        case SWEEP_COL:
+            for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
+                for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+                    order[n++] = (r << 8) | c;
+                }
+            }
+            break;
+            
+        case SWEEP_DIAG:
+            // Anti-diagonals from the top left corner, each one top to bottom
+            for (uint8_t k = 0; k < DISPLAY_HEIGHT + DISPLAY_WIDTH - 1; k++) {
+                uint8_t r_start = (k >= DISPLAY_WIDTH) ? k - DISPLAY_WIDTH + 1 : 0;
+                uint8_t r_end = (k < DISPLAY_HEIGHT) ? k : DISPLAY_HEIGHT - 1;
+                for (uint8_t r = r_start; r <= r_end; r++) {
+                    order[n++] = (r << 8) | (k - r);
+                }
+            }
+            break;
+            
+        case SWEEP_SERPENTINE:
+            for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+                for (uint8_t i = 0; i < DISPLAY_WIDTH; i++) {
+                    uint8_t c = (r & 1) ? DISPLAY_WIDTH - 1 - i : i;
+                    order[n++] = (r << 8) | c;
+                }
+            }
+            break;
+            
+        case SWEEP_SPIRAL: {
+            // Peel off one ring at a time: top, right, bottom, left
+            int top = 0, bottom = DISPLAY_HEIGHT - 1;
+            int left = 0, right = DISPLAY_WIDTH - 1;
+            while (top <= bottom && left <= right) {
+                for (int c = left; c <= right; c++) order[n++] = (top << 8) | c;
+                for (int r = top + 1; r <= bottom; r++) order[n++] = (r << 8) | right;
+                if (top < bottom) {
+                    for (int c = right - 1; c >= left; c--) order[n++] = (bottom << 8) | c;
+                }
+                if (left < right) {
+                    for (int r = bottom - 1; r > top; r--) order[n++] = (r << 8) | left;
+                }
+                top++; bottom--;
+                left++; right--;
+            }
+            break;
+        }
+            
+        case SWEEP_FASTEST: {
+            // Nested reflected Gray codes: row group, column group, row pixel,
+            // column pixel. Each level runs backwards on every other pass, so
+            // consecutive pixels differ in a single address line.
+            bool col_grp_rev = false, row_pix_rev = false, col_pix_rev = false;
+            for (uint8_t row_grp = 0; row_grp < (DISPLAY_HEIGHT + 6) / 7; row_grp++) {
+                for (uint8_t i = 0; i < 4; i++) {
+                    uint8_t col_grp = gray_group[col_grp_rev ? 3 - i : i];
+                    for (uint8_t j = 0; j < 7; j++) {
+                        uint8_t r = row_grp * 7 + gray_pixel[row_pix_rev ? 6 - j : j];
+                        for (uint8_t k = 0; k < 7; k++) {
+                            uint8_t c = col_grp * 7 + gray_pixel[col_pix_rev ? 6 - k : k];
+                            if (r < DISPLAY_HEIGHT && c < DISPLAY_WIDTH) {
+                                order[n++] = (r << 8) | c;
+                            }
+                        }
+                        col_pix_rev = !col_pix_rev;
+                    }
+                    row_pix_rev = !row_pix_rev;
+                }
+                col_grp_rev = !col_grp_rev;
+            }
+            break;
+        }
+            
+        case SWEEP_RANDOM:
+        case SWEEP_ROW:
+        default:
+            for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+                for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
+                    order[n++] = (r << 8) | c;
+                }
+            }
+            if (sweep_mode == SWEEP_RANDOM) {
+                shuffle_sweep_order(order);
+            }
+            break;
+    }
 }
 
 void flip_dot_set_pixel(flip_dot_t *display, uint8_t row, uint8_t col, bool value) {
-    uint8_t row_grp = row / 7;
-    uint8_t row_grp_pixel = row % 7;
-    
-    uint8_t col_grp = col / 7;
-    uint8_t col_grp_pixel = col % 7;
-    
-    ESP_LOGD(TAG, "Setting pixel (%d,%d) = %d", row, col, value);
-    ESP_LOGD(TAG, "Row: grp=%d, pixel=%d | Col: grp=%d, pixel=%d", row_grp, row_grp_pixel, col_grp, col_grp_pixel);
-    
-    // Set row output
-    uint8_t row_output_pos = row_grp_pixel + 1 + ((!value) * 8);
-    ESP_LOGD(TAG, "Row output position: %d", row_output_pos);
-    demux_74HC139_set_row_output(&display->enable_demux, row_grp, row_output_pos, &display->row_demux);
+    TRACE(FLIP_PIXEL, TRACE_PACK(row, col), value);
+    // No pulse into an unpowered board. The dot keeps its old state, so it
+    // stays dirty and the next update tries again.
+    if (flip_dot_prepare_supply(display) != ESP_OK) {
+        flip_dot_frame_set(&display->target, row, col, value);
+        return;
+    }
+    flip_dot_persist_mark(display, row, col, value);
     
-    // Set column output
-    uint8_t col_output_pos = col_grp_pixel + 1 + ((!value) * 8);
-    ESP_LOGD(TAG, "Column output position: %d", col_output_pos);
-    demux_74HC139_set_col_output(&display->enable_demux, col_grp, col_output_pos, &display->col_demux);
+    if (display->pipelined) {
+        // Latch the new address while the previous dot is still recovering,
+        // the pulse then starts from the ISR as soon as recovery ends
+        pulse_engine_wait_released(&display->pulse_engine);
+        flip_dot_write_address_timed(display, row, col, value);
+        TRACE(FLIP_PULSE_QUEUED, display->flip_time_us, display->recovery_time_us);
+        pulse_engine_queue(&display->pulse_engine, display->flip_time_us, display->recovery_time_us);
+    } else {
+        // Set row and column address in one go
+        flip_dot_write_address_timed(display, row, col, value);
+        
+        // Send column enable pulse, followed by the capacitor recovery gap
+        TRACE(FLIP_PULSE_FIRED, display->flip_time_us, display->recovery_time_us);
+        pulse_engine_fire(&display->pulse_engine, display->flip_time_us, display->recovery_time_us);
+    }
     
-    // Send column enable pulse
-    ESP_LOGD(TAG, "Sending enable pulse (pin=%d, inverted=%d)", display->enable_demux.pin_2E.pin, display->enable_demux.pin_2E.is_inverted);
-    gpio_write(display->enable_demux.pin_2E.pin, true, display->enable_demux.pin_2E.is_inverted);
-    delay_us(display->flip_time_us);
-    gpio_write(display->enable_demux.pin_2E.pin, false, display->enable_demux.pin_2E.is_inverted);
-    delay_us(1000); //Some recover delay for the capacitor to discharge completely. This can maybe be lower than 1ms, but since freertos is configured to 1000hz, smaller delays are not possible.
+    FLIP_DOT_STAT(
+        display->stats.pulses++;
+        display->stats.pulse_us += display->flip_time_us;
+        display->stats.recovery_us += display->recovery_time_us;
+        display->frame_flips++;
+    );
     
     // Update pixel state in memory
-    display->pixel_state[row][col] = value;
+    flip_dot_frame_set(&display->pixel_state, row, col, value);
+    flip_dot_frame_set(&display->target, row, col, value);
 }
 
 void flip_dot_clear_display(flip_dot_t *display) {
     ESP_LOGI(TAG, "Clearing display");
+    flip_dot_update_adaptive_timing(display);
+    int64_t start_us = esp_timer_get_time();
     for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
         for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
             //ESP_LOGI(TAG, "Clearing pixel (%d,%d)", r, c);
             flip_dot_set_pixel(display, r, c, false);
         }
     }
+    flip_dot_wait_idle(display);
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    ESP_LOGI(TAG, "Display cleared in %lld us (%lld pixels/s)", elapsed_us,
+             elapsed_us > 0 ? (DISPLAY_HEIGHT * DISPLAY_WIDTH * 1000000LL) / elapsed_us : 0);
 }
 
-void flip_dot_update_display(flip_dot_t *display, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
-    // Find which pixels need to change
-    uint8_t flip_list[DISPLAY_HEIGHT * DISPLAY_WIDTH][2];
-    uint16_t flip_count = 0;
+// Boot time clear. When the RTC mirror survived the reset only the dots that
+// were set, or had a pulse in flight, get pulsed off. Otherwise all of them.
+void flip_dot_clear_display_fast(flip_dot_t *display) {
+    if (!flip_dot_persist_valid(display)) {
+        ESP_LOGI(TAG, "No saved panel state, doing a full clear");
+        flip_dot_clear_display(display);
+        return;
+    }
     
+    int64_t start_us = esp_timer_get_time();
+    uint16_t count = 0;
     for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
-        for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
-            if (data[r][c] != display->pixel_state[r][c]) {
-                flip_list[flip_count][0] = r;
-                flip_list[flip_count][1] = c;
-                flip_count++;
+        display->pixel_state.rows[r] = (display->persist->state.rows[r] | display->persist->suspect.rows[r]) & FLIP_DOT_ROW_MASK;
+        count += __builtin_popcount(display->pixel_state.rows[r]);
+    }
+    
+    // Diffing against an empty frame pulses exactly those dots
+    flip_dot_frame_t empty;
+    flip_dot_frame_clear(&empty);
+    flip_dot_update_display_packed(display, &empty);
+    
+    ESP_LOGI(TAG, "Display cleared from saved state, %d dots in %lld us", count, esp_timer_get_time() - start_us);
+}
+
+void flip_dot_update_display(flip_dot_t *display, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
+    flip_dot_frame_t frame;
+    flip_dot_frame_pack(&frame, data);
+    flip_dot_update_display_packed(display, &frame);
+}
+
+uint16_t flip_dot_update_display_packed(flip_dot_t *display, const flip_dot_frame_t *frame) {
+    return flip_dot_update_display_stamped(display, frame, esp_timer_get_time());
+}
+
+// submit_us is when the producer handed the frame over, used for latency stats
+uint16_t flip_dot_update_display_stamped(flip_dot_t *display, const flip_dot_frame_t *frame, int64_t submit_us) {
+    flip_dot_open_frame(display, frame, submit_us);
+    return flip_dot_service(display);
+}
+
+void flip_dot_draw_transition(flip_dot_t *display, const flip_dot_frame_t *frame,
+                              flip_dot_transition_t effect, uint32_t duration_us) {
+    flip_dot_draw_transition_stamped(display, frame, effect, duration_us, esp_timer_get_time());
+}
+
+// Flips the whole difference to frame in the effect's order, with the recovery
+// gap stretched so the pulses come at an even interval over duration_us. The
+// gap never drops below the display's own recovery time, a transition with
+// more flips than fit in the duration just takes longer.
+void flip_dot_draw_transition_stamped(flip_dot_t *display, const flip_dot_frame_t *frame,
+                                      flip_dot_transition_t effect, uint32_t duration_us, int64_t submit_us) {
+    static const sweep_mode_t effect_orders[FLIP_DOT_TRANSITION_COUNT] = {
+        [FLIP_DOT_TRANSITION_WIPE] = SWEEP_COL,
+        [FLIP_DOT_TRANSITION_DISSOLVE] = SWEEP_RANDOM,
+        [FLIP_DOT_TRANSITION_SPIRAL] = SWEEP_SPIRAL,
+        [FLIP_DOT_TRANSITION_DIAGONAL] = SWEEP_DIAG,
+    };
+    
+    if (effect == FLIP_DOT_TRANSITION_CUT || effect >= FLIP_DOT_TRANSITION_COUNT) {
+        // A transition is one timed job, so the flip budget is suspended and
+        // the cut drawn in a single update. Dots left over because the supply
+        // is down stay dirty for the next update.
+        uint16_t max_flips = display->flip_budget;
+        uint32_t deadline_us = display->flip_deadline_us;
+        display->flip_budget = 0;
+        display->flip_deadline_us = 0;
+        flip_dot_open_frame(display, frame, submit_us);
+        flip_dot_service(display);
+        display->flip_budget = max_flips;
+        display->flip_deadline_us = deadline_us;
+        return;
+    }
+    
+    flip_dot_open_frame(display, frame, submit_us);
+    flip_dot_frame_t dirty;
+    uint16_t flip_count = flip_dot_get_dirty(display, &dirty);
+    if (flip_count == 0) {
+        display->sweep_cursor = 0;
+        flip_dot_close_frame(display);
+        return;
+    }
+    
+    flip_dot_update_adaptive_timing(display);
+    uint32_t recovery_us = display->recovery_time_us;
+    uint32_t interval_us = duration_us / flip_count;
+    if (interval_us > display->flip_time_us + recovery_us) {
+        display->recovery_time_us = interval_us - display->flip_time_us;
+    }
+    TRACE(FLIP_TRANSITION, TRACE_PACK(effect, flip_count), display->flip_time_us + display->recovery_time_us);
+    
+    uint16_t order[DISPLAY_PIXEL_COUNT];
+    flip_dot_build_sweep_order(effect_orders[effect], order);
+    bool powered = true;
+    for (uint16_t i = 0; i < DISPLAY_PIXEL_COUNT && powered; i++) {
+        uint8_t r = order[i] >> 8;
+        uint8_t c = order[i] & 0xFF;
+        if ((dirty.rows[r] >> c) & 1) {
+            powered = flip_dot_hold_supply(display) == ESP_OK;
+            if (powered) {
+                flip_dot_set_pixel(display, r, c, flip_dot_frame_get(&display->target, r, c));
             }
         }
     }
     
-    // Sort flip list according to sweep mode
+    flip_dot_wait_idle(display);
+    display->recovery_time_us = recovery_us;
+    display->sweep_cursor = 0;
+    // Without a supply the rest stays dirty for the next update
+    if (powered) {
+        flip_dot_close_frame(display);
+    }
+}
+
+uint16_t flip_dot_service(flip_dot_t *display) {
+    // Find which pixels need to change, one XOR per row
+    flip_dot_frame_t dirty;
+    uint16_t flip_count = flip_dot_get_dirty(display, &dirty);
+    
+    if (flip_count == 0) {
+        display->sweep_cursor = 0;
+        flip_dot_close_frame(display);
+        return 0;
+    }
+    
+    flip_dot_update_adaptive_timing(display);
+    
+    display->budget_flips_done = 0;
+    display->budget_deadline_us = esp_timer_get_time() + display->flip_deadline_us;
+    
+    // Flip pixels according to sweep mode
+    bool done;
     switch (display->sweep_mode) {
         case SWEEP_ROW:
-            // Already in row-by-row order
+            done = flip_dot_flip_rows(display, &dirty);
             break;
             
-        case SWEEP_COL:
-            // Sort by column
-            for (uint16_t i = 0; i < flip_count; i++) {
-                for (uint16_t j = i + 1; j < flip_count; j++) {
-                    if (flip_list[i][1] > flip_list[j][1]) {
-                        // Swap
-                        uint8_t temp_r = flip_list[i][0];
-                        uint8_t temp_c = flip_list[i][1];
-                        flip_list[i][0] = flip_list[j][0];
-                        flip_list[i][1] = flip_list[j][1];
-                        flip_list[j][0] = temp_r;
-                        flip_list[j][1] = temp_c;
-                    }
-                }
-            }
+        case SWEEP_FASTEST:
+            done = flip_dot_flip_by_value(display, &dirty);
             break;
             
         case SWEEP_RANDOM:
-            // Simple Fisher-Yates shuffle
-            for (uint16_t i = flip_count - 1; i > 0; i--) {
-                uint16_t j = rand() % (i + 1);
-                // Swap
-                uint8_t temp_r = flip_list[i][0];
-                uint8_t temp_c = flip_list[i][1];
-                flip_list[i][0] = flip_list[j][0];
-                flip_list[i][1] = flip_list[j][1];
-                flip_list[j][0] = temp_r;
-                flip_list[j][1] = temp_c;
-            }
+            // New random order for every update
+            shuffle_sweep_order(display->sweep_order);
+            done = flip_dot_flip_in_order(display, &dirty, flip_count);
             break;
             
-        case SWEEP_DIAG:
-            // Not implemented yet
+        default:
+            done = flip_dot_flip_in_order(display, &dirty, flip_count);
             break;
     }
     
-    // Set pixels according to the flip list
-    for (uint16_t i = 0; i < flip_count; i++) {
-        uint8_t r = flip_list[i][0];
-        uint8_t c = flip_list[i][1];
-        flip_dot_set_pixel(display, r, c, data[r][c]);
+    // The last pipelined pulse is still in flight
+    flip_dot_wait_idle(display);
+    
+    if (done) {
+        // Next frame sweeps from the start again
+        display->sweep_cursor = 0;
+        flip_dot_close_frame(display);
+        return 0;
+    }
+    FLIP_DOT_STAT(display->stats.updates_partial++);
+    return flip_dot_get_dirty(display, &dirty);
+}
+
+uint16_t flip_dot_get_pending_flips(flip_dot_t *display) {
+    flip_dot_frame_t dirty;
+    return flip_dot_get_dirty(display, &dirty);
+}
+
+TickType_t flip_dot_supply_retry_ticks(flip_dot_t *display) {
+    if (!display->supply_retry_us) {
+        return 0;
+    }
+    int64_t wait_us = display->supply_retry_us - esp_timer_get_time();
+    if (wait_us <= 0) {
+        return 0;
+    }
+    return pdMS_TO_TICKS((wait_us + 999) / 1000) + 1;
+}
+
+void flip_dot_set_pipelined(flip_dot_t *display, bool enable) {
+    // Let a running pulse chain finish before switching modes
+    flip_dot_wait_idle(display);
+    display->pipelined = enable;
+    ESP_LOGI(TAG, "Pipelined flipping %s", enable ? "enabled" : "disabled");
+}
+
+esp_err_t flip_dot_enable_adaptive_timing(flip_dot_t *display, flip_dot_voltage_reader_t read_voltage,
+                                          const flip_dot_timing_point_t *curve, uint8_t curve_len, uint32_t period_ms) {
+    if (!read_voltage || !curve || curve_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint8_t i = 1; i < curve_len; i++) {
+        if (curve[i].supply_mv <= curve[i - 1].supply_mv) {
+            ESP_LOGE(TAG, "Timing curve must be sorted by ascending supply voltage");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    // Probe once so a missing or uncalibrated ADC is reported up front
+    int mv;
+    esp_err_t ret = read_voltage(&mv);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Supply voltage unavailable (%s), keeping fixed timing", esp_err_to_name(ret));
+        return ret;
     }
     
-    // Update display state
-    memcpy(display->pixel_state, data, sizeof(display->pixel_state));
+    flip_dot_adaptive_timing_t *adaptive = &display->adaptive;
+    adaptive->curve = curve;
+    adaptive->curve_len = curve_len;
+    adaptive->period_us = period_ms * 1000;
+    adaptive->next_sample_us = 0;
+    adaptive->read_voltage = read_voltage;
+    flip_dot_update_adaptive_timing(display);
+    
+    ESP_LOGI(TAG, "Adaptive timing enabled, %d mV gives %ld us pulse, %ld us recovery",
+             adaptive->last_mv, display->flip_time_us, display->recovery_time_us);
+    return ESP_OK;
+}
+
+void flip_dot_disable_adaptive_timing(flip_dot_t *display) {
+    // Timing stays at the last adapted values
+    display->adaptive.read_voltage = NULL;
+}
+
+void flip_dot_get_stats(flip_dot_t *display, flip_dot_stats_t *stats) {
+    // Plain copy, a counter updated mid-copy may be one frame ahead of the rest
+    *stats = display->stats;
+}
+
+void flip_dot_reset_stats(flip_dot_t *display) {
+    memset(&display->stats, 0, sizeof(display->stats));
+}
+
+void flip_dot_print_stats(flip_dot_t *display) {
+    flip_dot_stats_t stats;
+    flip_dot_get_stats(display, &stats);
+    
+    uint32_t address_us = stats.address_cycles / esp_rom_get_cpu_ticks_per_us();
+    ESP_LOGI(TAG, "Frames: %ld drawn, %ld coalesced, %ld superseded, %ld partial updates",
+             stats.frames, stats.frames_coalesced, stats.frames_superseded, stats.updates_partial);
+    ESP_LOGI(TAG, "Flips: %ld pulses, last frame %d (max %d), dirty %d (max %d)",
+             stats.pulses, stats.last_flips, stats.max_flips, stats.last_dirty, stats.max_dirty);
+    ESP_LOGI(TAG, "Time: pulse %lld us, recovery %lld us, address setup %ld us (%ld ns per flip)",
+             stats.pulse_us, stats.recovery_us, address_us,
+             stats.pulses ? (uint32_t)(address_us * 1000ULL / stats.pulses) : 0);
+    ESP_LOGI(TAG, "Frame: last %ld us, latency %ld us (max %ld us)",
+             stats.last_frame_us, stats.last_latency_us, stats.max_latency_us);
+    ESP_LOGI(TAG, "Energy budget: %lld us waited", stats.energy_wait_us);
+}
+
+esp_err_t flip_dot_export_stats(flip_dot_t *display, flip_dot_stats_sink_t sink) {
+    uint8_t packet[2 + sizeof(flip_dot_stats_t)];
+    packet[0] = FLIP_DOT_STATS_PACKET_MAGIC;
+    packet[1] = FLIP_DOT_STATS_PACKET_VERSION;
+    
+    flip_dot_stats_t stats;
+    flip_dot_get_stats(display, &stats);
+    memcpy(&packet[2], &stats, sizeof(stats));
+    return sink(packet, sizeof(packet));
+}
+
+void flip_dot_set_flip_budget(flip_dot_t *display, uint16_t max_flips, uint32_t deadline_us) {
+    display->flip_budget = max_flips;
+    display->flip_deadline_us = deadline_us;
+    ESP_LOGI(TAG, "Flip budget set to %d flips, %ld us per update (0 = unlimited)", max_flips, deadline_us);
 }
 
 void flip_dot_set_rows_cols(flip_dot_t *display, uint8_t row_start, uint8_t row_end, uint8_t col_start, uint8_t col_end, bool pixel_value) {
@@ -427,6 +1292,7 @@ void flip_dot_set_rows_cols(flip_dot_t *display, uint8_t row_start, uint8_t row_
             flip_dot_set_pixel(display, r, c, pixel_value);
         }
     }
+    flip_dot_wait_idle(display);
 }
 
 void flip_dot_debug_pixel_calc(uint8_t row, uint8_t col, bool value) {
@@ -456,6 +1322,28 @@ void flip_dot_debug_pixel_calc(uint8_t row, uint8_t col, bool value) {
              col_binary[3], col_binary[2], col_binary[1], !col_binary[0]);
 }
 
+/******************************************************************************
+ * Packed Frame Functions
+ ******************************************************************************/
+
+void flip_dot_frame_pack(flip_dot_frame_t *frame, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        uint32_t row = 0;
+        for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
+            row |= (uint32_t)(data[r][c] != 0) << c;
+        }
+        frame->rows[r] = row;
+    }
+}
+
+void flip_dot_frame_unpack(const flip_dot_frame_t *frame, uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        for (uint8_t c = 0; c < DISPLAY_WIDTH; c++) {
+            data[r][c] = (frame->rows[r] >> c) & 1;
+        }
+    }
+}
+
 /******************************************************************************
  * Demo Functions
  ******************************************************************************/
@@ -471,19 +1359,16 @@ void flip_dot_demo_sine_wave(flip_dot_t *display, uint32_t delay_ms) {
         
         for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
             // Create a sine wave that moves across the display
-            float angle = (float)(col + frame) * 0.3f;
-            float sine_val = sinf(angle);
+            uint32_t angle = ((col + frame) * SINE_WAVE_ANGLE_STEP_Q8) >> 8;
             
             // Map sine wave (-1 to 1) to display height
-            int row = (int)(((sine_val + 1.0f) / 2.0f) * (DISPLAY_HEIGHT - 1));
+            int row = ((fixed_sin(angle) + FIXED_ONE) * (DISPLAY_HEIGHT - 1)) / (2 * FIXED_ONE);
             
             if (row >= 0 && row < DISPLAY_HEIGHT) {
                 display_buffer[row][col] = 1;
                 
                 // Add a second wave offset by 90 degrees
-                float angle2 = angle + (M_PI / 2.0f);
-                float sine_val2 = sinf(angle2);
-                int row2 = (int)(((sine_val2 + 1.0f) / 2.0f) * (DISPLAY_HEIGHT - 1));
+                int row2 = ((fixed_cos(angle) + FIXED_ONE) * (DISPLAY_HEIGHT - 1)) / (2 * FIXED_ONE);
                 
                 if (row2 >= 0 && row2 < DISPLAY_HEIGHT && row2 != row) {
                     display_buffer[row2][col] = 1;
@@ -492,7 +1377,7 @@ void flip_dot_demo_sine_wave(flip_dot_t *display, uint32_t delay_ms) {
         }
         
         // Update only changed pixels
-        flip_dot_update_display(display, display_buffer);
+        flip_dot_submit_frame(display, display_buffer);
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 }
@@ -500,46 +1385,41 @@ void flip_dot_demo_sine_wave(flip_dot_t *display, uint32_t delay_ms) {
 void flip_dot_demo_bouncing_ball(flip_dot_t *display, uint32_t delay_ms) {
     ESP_LOGI(TAG, "Starting bouncing ball demo");
     
-    uint8_t display_buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
-    float ball_x = 5.0f;
-    float ball_y = 5.0f;
-    float vel_x = 0.8f;
-    float vel_y = 0.6f;
+    // 3x3 ball as a sprite, only the dots it leaves and enters get recomposed
+    static const uint32_t ball_rows[] = { 0x7, 0x7, 0x7 };
+    static const flip_sprite_image_t ball_image = { .width = 3, .height = 3, .rows = ball_rows };
+    static flip_compositor_t comp;
+    flip_compositor_init(&comp, 1);
+    int8_t ball = flip_compositor_add_sprite(&comp, &ball_image, 0, FLIP_BLEND_OR);
+    
+    // Ball centre and speed in 1/256 dots
+    const int32_t one = 256;
+    const int32_t min_x = one, max_x = (DISPLAY_WIDTH - 2) * one;
+    const int32_t min_y = one, max_y = (DISPLAY_HEIGHT - 2) * one;
+    int32_t ball_x = 5 * one;
+    int32_t ball_y = 5 * one;
+    int32_t vel_x = 205;    // 0.8 dots per frame
+    int32_t vel_y = 154;    // 0.6 dots per frame
+    
+    flip_compositor_show_sprite(&comp, ball, true);
     
     for (uint32_t frame = 0; frame < 300; frame++) {
-        // Clear the buffer
-        memset(display_buffer, 0, sizeof(display_buffer));
-        
         // Update ball position
         ball_x += vel_x;
         ball_y += vel_y;
         
         // Bounce off walls
-        if (ball_x <= 1 || ball_x >= DISPLAY_WIDTH - 2) {
+        if (ball_x <= min_x || ball_x >= max_x) {
             vel_x = -vel_x;
-            ball_x = (ball_x <= 1) ? 1 : DISPLAY_WIDTH - 2;
+            ball_x = (ball_x <= min_x) ? min_x : max_x;
         }
-        if (ball_y <= 1 || ball_y >= DISPLAY_HEIGHT - 2) {
+        if (ball_y <= min_y || ball_y >= max_y) {
             vel_y = -vel_y;
-            ball_y = (ball_y <= 1) ? 1 : DISPLAY_HEIGHT - 2;
+            ball_y = (ball_y <= min_y) ? min_y : max_y;
         }
         
-        // Draw ball (3x3 square) in buffer
-        int center_x = (int)ball_x;
-        int center_y = (int)ball_y;
-        
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                int x = center_x + dx;
-                int y = center_y + dy;
-                if (x >= 0 && x < DISPLAY_WIDTH && y >= 0 && y < DISPLAY_HEIGHT) {
-                    display_buffer[y][x] = 1;
-                }
-            }
-        }
-        
-        // Update only changed pixels
-        flip_dot_update_display(display, display_buffer);
+        flip_compositor_move_sprite(&comp, ball, ball_x / one - 1, ball_y / one - 1);
+        flip_compositor_present(&comp, display);
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 }
@@ -586,7 +1466,7 @@ void flip_dot_demo_matrix_rain(flip_dot_t *display, uint32_t delay_ms) {
         }
         
         // Update only changed pixels
-        flip_dot_update_display(display, display_buffer);
+        flip_dot_submit_frame(display, display_buffer);
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 }
@@ -595,27 +1475,36 @@ void flip_dot_demo_ripple_effect(flip_dot_t *display, uint32_t delay_ms) {
     ESP_LOGI(TAG, "Starting ripple effect demo");
     
     uint8_t display_buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
-    float center_x = DISPLAY_WIDTH / 2.0f;
-    float center_y = DISPLAY_HEIGHT / 2.0f;
+    
+    // Distance of every dot from the centre in 1/256 dots, the rings only
+    // grow so this is all the geometry a frame needs
+    uint16_t dist[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    for (uint8_t row = 0; row < DISPLAY_HEIGHT; row++) {
+        for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
+            int32_t dx = col * 256 - DISPLAY_WIDTH * 128;
+            int32_t dy = row * 256 - DISPLAY_HEIGHT * 128;
+            dist[row][col] = fixed_isqrt(dx * dx + dy * dy);
+        }
+    }
     
     for (uint32_t frame = 0; frame < 100; frame++) {
         // Clear the buffer
         memset(display_buffer, 0, sizeof(display_buffer));
         
-        float radius1 = frame * 0.5f;
-        float radius2 = (frame > 20) ? (frame - 20) * 0.5f : 0;
-        float radius3 = (frame > 40) ? (frame - 40) * 0.5f : 0;
+        // Rings grow half a dot per frame, 0 means not started yet
+        int32_t radius1 = frame * 128;
+        int32_t radius2 = (frame > 20) ? (frame - 20) * 128 : 0;
+        int32_t radius3 = (frame > 40) ? (frame - 40) * 128 : 0;
         
         for (uint8_t row = 0; row < DISPLAY_HEIGHT; row++) {
             for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
-                float dist = sqrtf((col - center_x) * (col - center_x) + 
-                                 (row - center_y) * (row - center_y));
+                int32_t d = dist[row][col];
                 
                 // Check if pixel is on any of the ripple rings
                 bool on_ripple = false;
-                if (fabs(dist - radius1) < 0.8f && radius1 > 0) on_ripple = true;
-                if (fabs(dist - radius2) < 0.8f && radius2 > 0) on_ripple = true;
-                if (fabs(dist - radius3) < 0.8f && radius3 > 0) on_ripple = true;
+                if (abs(d - radius1) < RIPPLE_RING_HALF_WIDTH && radius1 > 0) on_ripple = true;
+                if (abs(d - radius2) < RIPPLE_RING_HALF_WIDTH && radius2 > 0) on_ripple = true;
+                if (abs(d - radius3) < RIPPLE_RING_HALF_WIDTH && radius3 > 0) on_ripple = true;
                 
                 if (on_ripple) {
                     display_buffer[row][col] = 1;
@@ -624,7 +1513,7 @@ void flip_dot_demo_ripple_effect(flip_dot_t *display, uint32_t delay_ms) {
         }
         
         // Update only changed pixels
-        flip_dot_update_display(display, display_buffer);
+        flip_dot_submit_frame(display, display_buffer);
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 }
@@ -632,46 +1521,20 @@ void flip_dot_demo_ripple_effect(flip_dot_t *display, uint32_t delay_ms) {
 void flip_dot_demo_scrolling_text(flip_dot_t *display, const char* text, uint32_t delay_ms) {
     ESP_LOGI(TAG, "Starting scrolling text demo: %s", text);
     
-    uint8_t display_buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
-    
-    // Simple 5x7 font for basic characters
-    const uint8_t font_A[7] = {0x1F, 0x24, 0x24, 0x24, 0x1F, 0x00, 0x00};
-    const uint8_t font_space[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    flip_dot_frame_t frame;
+    flip_dot_frame_clear(&frame);
     
-    int text_len = strlen(text);
-    int total_width = text_len * 6;  // 5 pixels + 1 space per character
+    // Center the 7 row font vertically
+    font_scroller_t scroller;
+    font_scroller_init(&scroller, &font_5x7, text, (DISPLAY_HEIGHT - font_5x7.height) / 2);
     
-    for (int offset = DISPLAY_WIDTH; offset > -total_width; offset--) {
-        // Clear the buffer
-        memset(display_buffer, 0, sizeof(display_buffer));
-        
-        for (int char_idx = 0; char_idx < text_len; char_idx++) {
-            int char_x = offset + char_idx * 6;
-            
-            const uint8_t* font_data;
-            if (text[char_idx] == 'A' || text[char_idx] == 'a') {
-                font_data = font_A;
-            } else {
-                font_data = font_space;  // Default to space for unsupported chars
-            }
-            
-            // Draw character in buffer
-            for (int col = 0; col < 5; col++) {
-                if (char_x + col >= 0 && char_x + col < DISPLAY_WIDTH) {
-                    for (int row = 0; row < 7; row++) {
-                        if (row + 3 < DISPLAY_HEIGHT) {  // Center vertically
-                            bool pixel = (font_data[col] >> row) & 1;
-                            if (pixel) {
-                                display_buffer[row + 3][char_x + col] = 1;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    // Feed the text in at the right edge until its last column has left on the left
+    int total_steps = DISPLAY_WIDTH + font_text_width(&font_5x7, text);
+    for (int step = 0; step < total_steps; step++) {
+        font_scroller_step(&scroller, &frame);
         
         // Update only changed pixels
-        flip_dot_update_display(display, display_buffer);
+        flip_dot_submit_frame_packed(display, &frame);
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 }
@@ -679,55 +1542,42 @@ void flip_dot_demo_scrolling_text(flip_dot_t *display, const char* text, uint32_
 void flip_dot_demo_game_of_life(flip_dot_t *display, uint32_t delay_ms, uint32_t generations) {
     ESP_LOGI(TAG, "Starting Conway's Game of Life demo");
     
-    uint8_t current_gen[DISPLAY_HEIGHT][DISPLAY_WIDTH];
-    uint8_t next_gen[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    // Ring of recent generations, a repeat within it means the board is stuck
+    flip_dot_frame_t history[LIFE_HISTORY_LEN];
+    uint8_t history_len = 0;
+    uint8_t history_head = 0;
+    flip_dot_frame_t board;
     
     // Initialize with random pattern
-    for (uint8_t row = 0; row < DISPLAY_HEIGHT; row++) {
-        for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
-            current_gen[row][col] = (rand() % 3 == 0) ? 1 : 0;  // ~33% chance of being alive
-        }
-    }
+    life_seed(&board);
     
     for (uint32_t gen = 0; gen < generations; gen++) {
-        // Calculate next generation
-        for (uint8_t row = 0; row < DISPLAY_HEIGHT; row++) {
-            for (uint8_t col = 0; col < DISPLAY_WIDTH; col++) {
-                // Count living neighbors
-                uint8_t neighbors = 0;
-                for (int dr = -1; dr <= 1; dr++) {
-                    for (int dc = -1; dc <= 1; dc++) {
-                        if (dr == 0 && dc == 0) continue;  // Skip center cell
-                        
-                        int nr = row + dr;
-                        int nc = col + dc;
-                        
-                        // Wrap around edges (toroidal topology)
-                        if (nr < 0) nr = DISPLAY_HEIGHT - 1;
-                        if (nr >= DISPLAY_HEIGHT) nr = 0;
-                        if (nc < 0) nc = DISPLAY_WIDTH - 1;
-                        if (nc >= DISPLAY_WIDTH) nc = 0;
-                        
-                        if (current_gen[nr][nc]) neighbors++;
-                    }
-                }
-                
-                // Apply Conway's rules
-                if (current_gen[row][col]) {
-                    // Cell is alive
-                    next_gen[row][col] = (neighbors == 2 || neighbors == 3) ? 1 : 0;
-                } else {
-                    // Cell is dead
-                    next_gen[row][col] = (neighbors == 3) ? 1 : 0;
-                }
-            }
+        flip_dot_frame_t next;
+        life_step(&board, &next);
+        
+        // Reseed boards that died out or settled into a still life or oscillator
+        bool stuck = true;
+        for (uint8_t r = 0; r < DISPLAY_HEIGHT && stuck; r++) {
+            stuck = next.rows[r] == 0;
+        }
+        for (uint8_t i = 0; i < history_len && !stuck; i++) {
+            stuck = life_frame_equal(&next, &history[i]);
+        }
+        if (stuck) {
+            ESP_LOGI(TAG, "Life board settled after %ld generations, reseeding", gen);
+            life_seed(&next);
+            history_len = 0;
         }
         
-        // Update display with new generation (only changed pixels)
-        flip_dot_update_display(display, next_gen);
+        history[history_head] = next;
+        history_head = (history_head + 1) % LIFE_HISTORY_LEN;
+        if (history_len < LIFE_HISTORY_LEN) {
+            history_len++;
+        }
+        board = next;
         
-        // Copy next generation to current
-        memcpy(current_gen, next_gen, sizeof(current_gen));
+        // Straight to the packed diff path, only changed dots are flipped
+        flip_dot_submit_frame_packed(display, &board);
         
         vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
@@ -11,6 +11,12 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "pulse_engine.h"
+#include "flip_dot_power.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 /******************************************************************************
  * Public Definitions and Types
@@ -19,15 +25,30 @@
 // Display dimensions
 #define DISPLAY_WIDTH 28
 #define DISPLAY_HEIGHT 13
+#define DISPLAY_PIXEL_COUNT (DISPLAY_WIDTH * DISPLAY_HEIGHT)
 
 // Sweep modes
 typedef enum {
     SWEEP_ROW,
     SWEEP_COL,
     SWEEP_DIAG,
-    SWEEP_RANDOM
+    SWEEP_RANDOM,
+    SWEEP_SERPENTINE,   // Rows, alternating direction
+    SWEEP_SPIRAL,       // Clockwise from the outer edge inwards
+    SWEEP_FASTEST,      // Fewest address line toggles, visual order not preserved
+    SWEEP_MODE_COUNT
 } sweep_mode_t;
 
+// Scene change effects, the flips are spread evenly over the duration
+typedef enum {
+    FLIP_DOT_TRANSITION_CUT = 0,    // Plain update in the display's sweep order
+    FLIP_DOT_TRANSITION_WIPE,       // Column by column, left to right
+    FLIP_DOT_TRANSITION_DISSOLVE,   // Random order
+    FLIP_DOT_TRANSITION_SPIRAL,     // Outer ring inwards
+    FLIP_DOT_TRANSITION_DIAGONAL,   // Anti-diagonals from the top left corner
+    FLIP_DOT_TRANSITION_COUNT
+} flip_dot_transition_t;
+
 // GPIO pin mapping
 typedef struct {
     uint8_t pin;
@@ -52,20 +73,175 @@ typedef struct {
     gpio_pin_t pin_2E;
 } demux_74HC139_t;
 
+// Panel wiring, every address and enable line of one panel. 0xFF marks an
+// unused pin.
+typedef struct {
+    gpio_pin_t row_A0;
+    gpio_pin_t row_A1;
+    gpio_pin_t row_A2;
+    gpio_pin_t row_A3;
+    gpio_pin_t col_A0;
+    gpio_pin_t col_A1;
+    gpio_pin_t col_A2;
+    gpio_pin_t col_A3;
+    gpio_pin_t enable_1A0;
+    gpio_pin_t enable_1A1;
+    gpio_pin_t enable_2A0;
+    gpio_pin_t enable_2A1;
+    gpio_pin_t enable_1E;
+    gpio_pin_t enable_2E;   // Coil enable, driven by the pulse engine
+} flip_dot_pins_t;
+
+// Packed frame, one word per row with bit c holding column c
+typedef struct {
+    uint32_t rows[DISPLAY_HEIGHT];
+} flip_dot_frame_t;
+
+_Static_assert(DISPLAY_WIDTH <= 32, "A display row must fit in one packed word");
+
+// Single dot change for delta submission
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    bool value;
+} flip_dot_change_t;
+
+// GPIO output word split over the two ESP32 GPIO banks (GPIO0-31, GPIO32-39)
+typedef struct {
+    uint32_t bank[2];
+} flip_dot_gpio_word_t;
+
+// Asynchronous render state, frames are double buffered between producers
+// (back buffer, latest submitted frame) and the render task (front buffer)
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t started;  // Given once the task owns the pulse engine
+    SemaphoreHandle_t idle;     // Given each time the task goes idle
+    portMUX_TYPE lock;
+    flip_dot_frame_t frames[2];
+    int64_t submit_us[2];   // When each frame was submitted, for latency stats
+    flip_dot_transition_t transition[2];    // How each frame is to be drawn
+    uint32_t transition_us[2];
+    uint8_t front;          // Index of the frame currently being flipped
+    volatile bool pending;  // Back buffer holds a frame not yet picked up
+    volatile bool busy;     // Render task is flipping the front buffer
+    volatile int64_t idle_us;   // When the task last went idle
+} flip_dot_renderer_t;
+
+// Supply voltage reader, same signature as get_battery_voltage()
+typedef esp_err_t (*flip_dot_voltage_reader_t)(int *voltage_mv);
+
+// One calibration point, coil timing that reliably flips at supply_mv
+typedef struct {
+    int supply_mv;
+    uint32_t flip_time_us;
+    uint32_t recovery_time_us;
+} flip_dot_timing_point_t;
+
+// Voltage-adaptive pulse timing, sampled once per period rather than per flip
+typedef struct {
+    flip_dot_voltage_reader_t read_voltage;  // NULL when adaptive timing is off
+    const flip_dot_timing_point_t *curve;    // Sorted by ascending supply_mv
+    uint8_t curve_len;
+    uint32_t period_us;
+    int64_t next_sample_us;
+    int last_mv;
+} flip_dot_adaptive_timing_t;
+
+// Driver counters, kept when CONFIG_FLIP_DOT_STATS is set
+typedef struct {
+    uint32_t frames;             // Frames drawn to completion
+    uint32_t frames_coalesced;   // Submitted frames replaced before the render task picked them up
+    uint32_t frames_superseded;  // Frames replaced by a newer one while partly drawn
+    uint32_t updates_partial;    // Updates that ran out of flip budget
+    uint32_t pulses;             // Coil pulses fired
+    uint16_t last_flips;         // Flips it took to draw the last frame
+    uint16_t max_flips;
+    uint16_t last_dirty;         // Dirty set size when the last frame was taken up
+    uint16_t max_dirty;
+    uint64_t pulse_us;           // Time the enable line was driven
+    uint64_t recovery_us;        // Time spent in recovery gaps
+    uint64_t address_cycles;     // CPU cycles spent writing row/col addresses
+    uint32_t last_frame_us;      // Wall time from taking up the last frame to done
+    uint32_t last_latency_us;    // Submit to done for the last frame
+    uint32_t max_latency_us;
+    uint64_t energy_wait_us;     // Time pulses waited on the energy budget
+} flip_dot_stats_t;
+
+// Sink for exported stats, same signature as input_espnow_send()
+typedef esp_err_t (*flip_dot_stats_sink_t)(const uint8_t *data, size_t len);
+
+// RTC memory mirror of one panel, private to flip_dot.c
+struct flip_dot_persist;
+
 // FlipFlop display controller
 typedef struct {
     demux_74HC139_t enable_demux;
     demux_74HC4514_t col_demux;
     demux_74HC4514_t row_demux;
+    pulse_engine_t pulse_engine;
+    flip_dot_gpio_word_t addr_mask;                    // Every row/col address pin
+    flip_dot_gpio_word_t row_addr[2][DISPLAY_HEIGHT];  // Address pin levels, indexed [value][row]
+    flip_dot_gpio_word_t col_addr[2][DISPLAY_WIDTH];   // Address pin levels, indexed [value][col]
+    flip_dot_gpio_word_t addr_state;                   // Levels currently driven on the address pins
+    bool addr_state_valid;
     uint32_t flip_time_us;
+    uint32_t recovery_time_us;
     sweep_mode_t sweep_mode;
-    uint8_t pixel_state[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    uint16_t sweep_order[DISPLAY_PIXEL_COUNT];  // Traversal order of sweep_mode, row << 8 | col
+    flip_dot_frame_t pixel_state;
+    flip_dot_frame_t target;        // Latest requested frame, pixel_state converges towards it
+    uint16_t sweep_cursor;          // Sweep table index a budget-limited update resumes at
+    uint16_t flip_budget;           // Max flips per update, 0 for unlimited
+    uint32_t flip_deadline_us;      // Max time per update, 0 for unlimited
+    uint16_t budget_flips_done;     // Flips so far in this update
+    int64_t budget_deadline_us;
+    bool pipelined;                 // Latch the next address during the current recovery gap
+    flip_dot_adaptive_timing_t adaptive;
+    flip_dot_stats_t stats;
+    bool frame_open;                // A frame is taken up but not fully drawn
+    uint16_t frame_flips;
+    int64_t frame_start_us;
+    int64_t frame_submit_us;
+    flip_dot_renderer_t renderer;
+    struct flip_dot_persist *persist;  // NULL when no RTC slot is left
+    flip_dot_energy_budget_t *energy_budget;  // Shared coil-on budget, NULL for none
+    flip_dot_supply_gate_t *supply_gate;      // Idle supply gating, NULL for always on
+    bool supply_held;               // Holds a supply gate reference until the pulses are done
+    int64_t supply_retry_us;        // Supply failed to come up, no power-up before this time, 0 for none
 } flip_dot_t;
 
 /******************************************************************************
  * Public Constants
  ******************************************************************************/
 
+// Capacitor recovery gap after each coil pulse
+#define FLIP_DOT_DEFAULT_RECOVERY_US 1000
+
+// Stats packet tag, the flip_dot_stats_t follows in native layout
+#define FLIP_DOT_STATS_PACKET_MAGIC 0xF5
+#define FLIP_DOT_STATS_PACKET_VERSION 2
+
+#if CONFIG_FLIP_DOT_STATS
+#define FLIP_DOT_STAT(expr) do { expr; } while (0)
+#else
+#define FLIP_DOT_STAT(expr) do { } while (0)
+#endif
+
+// Valid column bits of a packed row
+#define FLIP_DOT_ROW_MASK ((uint32_t)((1ULL << DISPLAY_WIDTH) - 1))
+
+// Render task defaults, see the task layout in Kconfig.projbuild
+#define FLIP_DOT_RENDER_TASK_STACK_SIZE 4096
+#define FLIP_DOT_RENDER_TASK_PRIORITY CONFIG_FLIP_DOT_RENDER_TASK_PRIORITY
+#define FLIP_DOT_RENDER_TASK_CORE CONFIG_FLIP_DOT_RENDER_TASK_CORE
+#define FLIP_DOT_RENDER_START_TIMEOUT_MS 1000
+
+// Wait between the budget slices of one frame, lower priority tasks run meanwhile
+#define FLIP_DOT_RENDER_SLICE_TICKS 1
+
+// Backoff after the flip board supply failed to come up
+#define FLIP_DOT_SUPPLY_RETRY_MS 2000
 
 /******************************************************************************
  * Public Function Declarations
@@ -73,10 +249,84 @@ typedef struct {
 
 // Flip dot display functions
 void flip_dot_init(flip_dot_t *display, uint32_t flip_time_us, sweep_mode_t sweep_mode);
+void flip_dot_init_with_pins(flip_dot_t *display, const flip_dot_pins_t *pins, uint32_t flip_time_us, sweep_mode_t sweep_mode);
+flip_dot_pins_t flip_dot_get_default_pins(void);
+uint64_t flip_dot_pins_mask(const flip_dot_pins_t *pins);
+void flip_dot_set_power_tokens(flip_dot_t *display, SemaphoreHandle_t tokens);
+void flip_dot_set_energy_budget(flip_dot_t *display, flip_dot_energy_budget_t *budget);
+void flip_dot_set_supply_gate(flip_dot_t *display, flip_dot_supply_gate_t *gate);
+void flip_dot_set_timing(flip_dot_t *display, uint32_t flip_time_us, uint32_t recovery_time_us);
+void flip_dot_set_sweep_mode(flip_dot_t *display, sweep_mode_t sweep_mode);
+void flip_dot_build_sweep_order(sweep_mode_t sweep_mode, uint16_t order[DISPLAY_PIXEL_COUNT]);
 void flip_dot_set_pixel(flip_dot_t *display, uint8_t row, uint8_t col, bool value);
 void flip_dot_update_display(flip_dot_t *display, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]);
+uint16_t flip_dot_update_display_packed(flip_dot_t *display, const flip_dot_frame_t *frame);
+uint16_t flip_dot_update_display_stamped(flip_dot_t *display, const flip_dot_frame_t *frame, int64_t submit_us);
+uint16_t flip_dot_service(flip_dot_t *display);
+uint16_t flip_dot_get_pending_flips(flip_dot_t *display);
+// Ticks until a failed flip board supply is tried again, 0 when it is not down
+TickType_t flip_dot_supply_retry_ticks(flip_dot_t *display);
+// Caps the flips of one update, at least one flip is always made
+void flip_dot_set_flip_budget(flip_dot_t *display, uint16_t max_flips, uint32_t deadline_us);
+void flip_dot_set_pipelined(flip_dot_t *display, bool enable);
+esp_err_t flip_dot_enable_adaptive_timing(flip_dot_t *display, flip_dot_voltage_reader_t read_voltage,
+                                          const flip_dot_timing_point_t *curve, uint8_t curve_len, uint32_t period_ms);
+void flip_dot_disable_adaptive_timing(flip_dot_t *display);
+
+// Driver stats
+void flip_dot_get_stats(flip_dot_t *display, flip_dot_stats_t *stats);
+void flip_dot_reset_stats(flip_dot_t *display);
+void flip_dot_print_stats(flip_dot_t *display);
+esp_err_t flip_dot_export_stats(flip_dot_t *display, flip_dot_stats_sink_t sink);
 void flip_dot_set_rows_cols(flip_dot_t *display, uint8_t row_start, uint8_t row_end, uint8_t col_start, uint8_t col_end, bool pixel_value);
 void flip_dot_clear_display(flip_dot_t *display);
+void flip_dot_clear_display_fast(flip_dot_t *display);
+void flip_dot_draw_transition(flip_dot_t *display, const flip_dot_frame_t *frame,
+                              flip_dot_transition_t effect, uint32_t duration_us);
+void flip_dot_draw_transition_stamped(flip_dot_t *display, const flip_dot_frame_t *frame,
+                                      flip_dot_transition_t effect, uint32_t duration_us, int64_t submit_us);
+
+// Render task functions. Once the render task runs it owns the panel, other
+// tasks must go through flip_dot_submit_frame() instead of the calls above.
+esp_err_t flip_dot_render_start(flip_dot_t *display, BaseType_t core_id, UBaseType_t priority);
+void flip_dot_submit_frame(flip_dot_t *display, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]);
+void flip_dot_submit_frame_packed(flip_dot_t *display, const flip_dot_frame_t *frame);
+void flip_dot_apply_changes(flip_dot_t *display, const flip_dot_change_t *changes, uint16_t count);
+void flip_dot_transition(flip_dot_t *display, const flip_dot_frame_t *frame,
+                         flip_dot_transition_t effect, uint32_t duration_us);
+bool flip_dot_render_is_idle(flip_dot_t *display);
+// Blocks until the render task has drawn everything submitted, or timeout
+// passes on one wait. idle_us, when given, is when the task went idle.
+bool flip_dot_render_wait_idle(flip_dot_t *display, TickType_t timeout, int64_t *idle_us);
+
+// Packed frame functions
+void flip_dot_frame_pack(flip_dot_frame_t *frame, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]);
+void flip_dot_frame_unpack(const flip_dot_frame_t *frame, uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]);
+
+static inline void flip_dot_frame_clear(flip_dot_frame_t *frame) {
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        frame->rows[r] = 0;
+    }
+}
+
+static inline bool flip_dot_frame_get(const flip_dot_frame_t *frame, uint8_t row, uint8_t col) {
+    return (frame->rows[row] >> col) & 1;
+}
+
+static inline void flip_dot_frame_set(flip_dot_frame_t *frame, uint8_t row, uint8_t col, bool value) {
+    if (value) {
+        frame->rows[row] |= 1UL << col;
+    } else {
+        frame->rows[row] &= ~(1UL << col);
+    }
+}
+
+// Changes are applied in order, a later change to the same dot wins
+static inline void flip_dot_frame_apply_changes(flip_dot_frame_t *frame, const flip_dot_change_t *changes, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        flip_dot_frame_set(frame, changes[i].row, changes[i].col, changes[i].value);
+    }
+}
 
 // Demo functions
 void flip_dot_demo_sine_wave(flip_dot_t *display, uint32_t delay_ms);
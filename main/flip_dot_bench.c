@@ -0,0 +1,259 @@
+/**
+ * @file flip_dot_bench.c
+ * @brief On-target throughput benchmark for the flip dot driver
+ *
+ * Runs a fixed set of workloads through the normal submit path and times
+ * every frame from submit until the render task goes idle. The render task
+ * stamps that moment itself when it signals idle, so the wait adds nothing.
+ * The stamp is in esp_timer microseconds: the CPU cycle counters of the two
+ * cores are not in step. Per workload it logs pixels/s, the enable line
+ * width measured by the pulse engine ISR against the requested one, and the
+ * share of one core the render task used. The host simulator cannot model
+ * the coils or the ISR latency, this is what validates pulse engine and
+ * scheduler changes on the real panel.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_FLIP_DOT_BENCHMARK
+
+#include "flip_dot_bench.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_dot_bench";
+
+#define BENCH_CLEAR_ROUNDS          3
+#define BENCH_CHECKER_FRAMES        6
+#define BENCH_SCROLL_WIDTH          64      // Banner width, scrolled one column per frame
+#define BENCH_CHURN_FRAMES          40
+#define BENCH_CHURN_DOTS            (DISPLAY_PIXEL_COUNT / 10)
+
+// Accumulated timing of one workload
+typedef struct {
+    flip_dot_t *display;
+    uint32_t frames;
+    uint32_t flips;
+    uint64_t elapsed_us;
+} bench_run_t;
+
+typedef struct {
+    const char *name;
+    void (*run)(bench_run_t *run);
+} bench_workload_t;
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static uint32_t bench_render_runtime_us(TaskHandle_t task);
+static int64_t bench_wait_idle(flip_dot_t *display);
+static void bench_setup(flip_dot_t *display, const flip_dot_frame_t *frame);
+static void bench_frame(bench_run_t *run, const flip_dot_frame_t *frame);
+static void bench_full_clear(bench_run_t *run);
+static void bench_checkerboard(bench_run_t *run);
+static void bench_scroll(bench_run_t *run);
+static void bench_churn(bench_run_t *run);
+static void bench_report(const bench_workload_t *workload, const bench_run_t *run, uint32_t render_us, uint32_t wall_us);
+
+static const bench_workload_t bench_workloads[] = {
+    { "full_clear", bench_full_clear },
+    { "checker_inv", bench_checkerboard },
+    { "scroll", bench_scroll },
+    { "churn_10pct", bench_churn },
+};
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+// Render task run time in esp_timer microseconds, 0 when it cannot be measured
+static uint32_t bench_render_runtime_us(TaskHandle_t task) {
+#if CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER
+    return task ? ulTaskGetRunTimeCounter(task) : 0;
+#else
+    return 0;
+#endif
+}
+
+// Returns when the render task went idle
+static int64_t bench_wait_idle(flip_dot_t *display) {
+    int64_t idle_us;
+    flip_dot_render_wait_idle(display, portMAX_DELAY, &idle_us);
+    return idle_us;
+}
+
+// Untimed frame, puts the panel in the state a workload starts from
+static void bench_setup(flip_dot_t *display, const flip_dot_frame_t *frame) {
+    flip_dot_submit_frame_packed(display, frame);
+    bench_wait_idle(display);
+}
+
+static void bench_frame(bench_run_t *run, const flip_dot_frame_t *frame) {
+    flip_dot_stats_t before, after;
+    flip_dot_get_stats(run->display, &before);
+    
+    int64_t start_us = esp_timer_get_time();
+    flip_dot_submit_frame_packed(run->display, frame);
+    run->elapsed_us += bench_wait_idle(run->display) - start_us;
+    
+    flip_dot_get_stats(run->display, &after);
+    run->flips += after.pulses - before.pulses;
+    run->frames++;
+}
+
+// All dots set, then one frame clearing all of them
+static void bench_full_clear(bench_run_t *run) {
+    flip_dot_frame_t on, off;
+    flip_dot_frame_clear(&off);
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        on.rows[r] = FLIP_DOT_ROW_MASK;
+    }
+    for (int i = 0; i < BENCH_CLEAR_ROUNDS; i++) {
+        bench_setup(run->display, &on);
+        bench_frame(run, &off);
+    }
+}
+
+// Every dot flips on every frame
+static void bench_checkerboard(bench_run_t *run) {
+    flip_dot_frame_t checker[2];
+    for (uint8_t r = 0; r < DISPLAY_HEIGHT; r++) {
+        checker[0].rows[r] = ((r & 1) ? 0xAAAAAAAAUL : 0x55555555UL) & FLIP_DOT_ROW_MASK;
+        checker[1].rows[r] = ~checker[0].rows[r] & FLIP_DOT_ROW_MASK;
+    }
+    bench_setup(run->display, &checker[0]);
+    for (int i = 0; i < BENCH_CHECKER_FRAMES; i++) {
+        bench_frame(run, &checker[(i + 1) & 1]);
+    }
+}
+
+// Text-like banner, 5 column glyph cells with a blank column between them,
+// scrolled through the middle seven rows one column per frame
+static void bench_scroll(bench_run_t *run) {
+    uint64_t banner[7] = {0};
+    srand(18);
+    for (int col = 0; col < BENCH_SCROLL_WIDTH; col++) {
+        if (col % 6 == 5) {
+            continue;
+        }
+        for (int row = 0; row < 7; row++) {
+            if (rand() % 5 < 2) {
+                banner[row] |= 1ULL << col;
+            }
+        }
+    }
+    
+    flip_dot_frame_t frame;
+    flip_dot_frame_clear(&frame);
+    bench_setup(run->display, &frame);
+    for (int offset = 0; offset < BENCH_SCROLL_WIDTH; offset++) {
+        for (int row = 0; row < 7; row++) {
+            // Rotate, a shift by the full 64 bits at offset 0 is undefined
+            uint64_t window = offset == 0 ? banner[row] :
+                              (banner[row] >> offset) | (banner[row] << (BENCH_SCROLL_WIDTH - offset));
+            frame.rows[row + 3] = (uint32_t)window & FLIP_DOT_ROW_MASK;
+        }
+        bench_frame(run, &frame);
+    }
+}
+
+// 10% of the dots, picked at random, toggle on every frame
+static void bench_churn(bench_run_t *run) {
+    uint16_t cells[DISPLAY_PIXEL_COUNT];
+    for (uint16_t i = 0; i < DISPLAY_PIXEL_COUNT; i++) {
+        cells[i] = i;
+    }
+    
+    flip_dot_frame_t frame;
+    flip_dot_frame_clear(&frame);
+    bench_setup(run->display, &frame);
+    srand(10);
+    for (int i = 0; i < BENCH_CHURN_FRAMES; i++) {
+        // Partial shuffle, the first BENCH_CHURN_DOTS cells are distinct picks
+        for (uint16_t j = 0; j < BENCH_CHURN_DOTS; j++) {
+            uint16_t k = j + rand() % (DISPLAY_PIXEL_COUNT - j);
+            uint16_t cell = cells[k];
+            cells[k] = cells[j];
+            cells[j] = cell;
+            frame.rows[cell / DISPLAY_WIDTH] ^= 1UL << (cell % DISPLAY_WIDTH);
+        }
+        bench_frame(run, &frame);
+    }
+}
+
+static void bench_report(const bench_workload_t *workload, const bench_run_t *run, uint32_t render_us, uint32_t wall_us) {
+    uint32_t cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+    uint64_t elapsed_us = run->elapsed_us;
+    uint32_t pixels_per_s = elapsed_us ? (uint32_t)(run->flips * 1000000ULL / elapsed_us) : 0;
+    
+    ESP_LOGI(TAG, "%-12s %3lu frames %5lu flips %7lu ms %4lu px/s",
+             workload->name, run->frames, run->flips, (uint32_t)(elapsed_us / 1000), pixels_per_s);
+    
+    pulse_engine_accuracy_t accuracy;
+    pulse_engine_get_accuracy(&run->display->pulse_engine, &accuracy);
+    if (accuracy.count > 0) {
+        int32_t mean_ns = (int32_t)(accuracy.sum_error_cycles * 1000 / accuracy.count / cycles_per_us);
+        ESP_LOGI(TAG, "%-12s pulse width error over %lu pulses: mean %+ld ns, min %+ld ns, max %+ld ns",
+                 "", accuracy.count, mean_ns,
+                 accuracy.min_error_cycles * 1000 / (int32_t)cycles_per_us,
+                 accuracy.max_error_cycles * 1000 / (int32_t)cycles_per_us);
+    } else {
+        ESP_LOGI(TAG, "%-12s no ISR-chained pulses to measure, is pipelining on?", "");
+    }
+    
+    if (render_us > 0 && wall_us > 0) {
+        ESP_LOGI(TAG, "%-12s render task CPU %lu.%lu%% of one core", "",
+                 (uint32_t)(render_us * 100ULL / wall_us), (uint32_t)(render_us * 1000ULL / wall_us % 10));
+    } else {
+        ESP_LOGI(TAG, "%-12s render task CPU share not available", "");
+    }
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+void flip_dot_bench_run(flip_dot_t *display) {
+    TaskHandle_t render_task = display->renderer.task;
+    
+    ESP_LOGI(TAG, "Benchmark: %ld us pulse, %ld us recovery, %s, %s", 
+             display->flip_time_us, display->recovery_time_us,
+             display->pipelined ? "pipelined" : "serial",
+             render_task ? "render task" : "synchronous");
+    
+    for (size_t i = 0; i < sizeof(bench_workloads) / sizeof(bench_workloads[0]); i++) {
+        bench_run_t run = {
+            .display = display,
+        };
+        
+        pulse_engine_reset_accuracy(&display->pulse_engine);
+        int64_t wall_start = esp_timer_get_time();
+        uint32_t render_start = bench_render_runtime_us(render_task);
+        
+        bench_workloads[i].run(&run);
+        
+        uint32_t wall_us = esp_timer_get_time() - wall_start;
+        uint32_t render_us = bench_render_runtime_us(render_task) - render_start;
+        bench_report(&bench_workloads[i], &run, render_us, wall_us);
+    }
+    
+    // Leave the panel blank for whatever runs next
+    flip_dot_frame_t off;
+    flip_dot_frame_clear(&off);
+    bench_setup(display, &off);
+    flip_dot_print_stats(display);
+}
+
+#endif /* CONFIG_FLIP_DOT_BENCHMARK */
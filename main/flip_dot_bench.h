@@ -0,0 +1,22 @@
+/**
+ * @file flip_dot_bench.h
+ * @brief On-target throughput benchmark for the flip dot driver
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_DOT_BENCH_H
+#define FLIP_DOT_BENCH_H
+
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Runs the standard workloads on the real panel and logs the results.
+// Takes over the display, producers must be stopped while it runs.
+void flip_dot_bench_run(flip_dot_t *display);
+
+#endif /* FLIP_DOT_BENCH_H */
@@ -0,0 +1,78 @@
+/**
+ * @file flip_dot_hal.h
+ * @brief Pin access seam under the flip dot driver
+ *
+ * Everything the driver does to the panel address lines goes through these
+ * calls. On the ESP32 they are thin inlines over the GPIO driver and the
+ * W1TS/W1TC registers. Host builds (CONFIG_FLIP_DOT_HOST_SIM) link them
+ * against the simulated panel in host/ instead, together with a simulated
+ * pulse engine.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_DOT_HAL_H
+#define FLIP_DOT_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+#if CONFIG_FLIP_DOT_HOST_SIM
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Implemented by the simulated panel
+void flip_dot_hal_config_outputs(uint64_t pin_mask);
+void flip_dot_hal_gpio_write(uint8_t pin, bool level);
+void flip_dot_hal_bank_write(uint8_t bank, uint32_t set_mask, uint32_t clear_mask);
+void flip_dot_hal_delay_us(uint32_t us);
+
+#else
+
+#include "driver/gpio.h"
+#include "esp_rom_sys.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+// Configures every pin in the mask as a plain push-pull output
+static inline void flip_dot_hal_config_outputs(uint64_t pin_mask) {
+    gpio_config_t io_config = {
+        .pin_bit_mask = pin_mask,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&io_config);
+}
+
+static inline void flip_dot_hal_gpio_write(uint8_t pin, bool level) {
+    gpio_set_level(pin, level);
+}
+
+// Clears then sets lines of one GPIO bank (0: GPIO0-31, 1: GPIO32-39)
+static inline void flip_dot_hal_bank_write(uint8_t bank, uint32_t set_mask, uint32_t clear_mask) {
+    if (bank == 0) {
+        REG_WRITE(GPIO_OUT_W1TC_REG, clear_mask);
+        REG_WRITE(GPIO_OUT_W1TS_REG, set_mask);
+    } else {
+        REG_WRITE(GPIO_OUT1_W1TC_REG, clear_mask);
+        REG_WRITE(GPIO_OUT1_W1TS_REG, set_mask);
+    }
+}
+
+static inline void flip_dot_hal_delay_us(uint32_t us) {
+    esp_rom_delay_us(us);
+}
+
+#endif /* CONFIG_FLIP_DOT_HOST_SIM */
+
+#endif /* FLIP_DOT_HAL_H */
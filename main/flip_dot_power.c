@@ -0,0 +1,157 @@
+/**
+ * @file flip_dot_power.c
+ * @brief Coil energy budget and idle gating of the flip board supply
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "flip_dot_power.h"
+#include "esp_log.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_dot_power";
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static void flip_dot_supply_gate_on_idle(void *arg);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+// Runs in the esp_timer task once the last reference has been idle long enough.
+// The lock is held across a power-up, which takes over a second, so a busy lock
+// re-arms the timer instead of stalling every other esp_timer callback.
+static void flip_dot_supply_gate_on_idle(void *arg) {
+    flip_dot_supply_gate_t *gate = arg;
+
+    if (xSemaphoreTake(gate->lock, 0) != pdTRUE) {
+        esp_timer_start_once(gate->idle_timer, gate->idle_off_us);
+        return;
+    }
+    if (gate->refs == 0 && gate->on) {
+        gate->disable();
+        gate->on = false;
+        ESP_LOGD(TAG, "Flip board supply off after %ld ms idle", gate->idle_off_us / 1000);
+    }
+    xSemaphoreGive(gate->lock);
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+void flip_dot_energy_budget_init(flip_dot_energy_budget_t *budget, uint32_t max_on_us, uint32_t window_us) {
+    portMUX_INITIALIZE(&budget->lock);
+    budget->max_on_us = max_on_us;
+    budget->window_us = window_us;
+    budget->level = (int64_t)max_on_us * window_us;
+    budget->refilled_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Energy budget %ld us coil-on per %ld us", max_on_us, window_us);
+}
+
+uint32_t flip_dot_energy_budget_take(flip_dot_energy_budget_t *budget, uint32_t pulse_us) {
+    // Scaled by window_us so the refill rate max_on_us / window_us stays exact
+    int64_t capacity = (int64_t)budget->max_on_us * budget->window_us;
+    int64_t cost = (int64_t)pulse_us * budget->window_us;
+    uint32_t wait_us = 0;
+
+    // A pulse longer than a whole window could never fit, let it drain the bucket
+    if (cost > capacity) {
+        cost = capacity;
+    }
+
+    portENTER_CRITICAL(&budget->lock);
+    int64_t now = esp_timer_get_time();
+    budget->level += (now - budget->refilled_us) * budget->max_on_us;
+    budget->refilled_us = now;
+    if (budget->level > capacity) {
+        budget->level = capacity;
+    }
+    if (budget->level >= cost) {
+        budget->level -= cost;
+    } else {
+        wait_us = (cost - budget->level + budget->max_on_us - 1) / budget->max_on_us;
+    }
+    portEXIT_CRITICAL(&budget->lock);
+
+    return wait_us;
+}
+
+esp_err_t flip_dot_supply_gate_init(flip_dot_supply_gate_t *gate, flip_dot_supply_switch_t enable,
+                                    flip_dot_supply_switch_t disable, uint32_t idle_off_ms, bool is_on) {
+    if (!enable || !disable) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gate->enable = enable;
+    gate->disable = disable;
+    gate->idle_off_us = idle_off_ms * 1000;
+    gate->refs = 0;
+    gate->on = is_on;
+    gate->power_ups = 0;
+
+    gate->lock = xSemaphoreCreateMutex();
+    if (!gate->lock) {
+        ESP_LOGE(TAG, "Failed to create supply gate lock");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = flip_dot_supply_gate_on_idle,
+        .arg = gate,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "flip_supply_idle",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &gate->idle_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create supply idle timer: %s", esp_err_to_name(ret));
+        vSemaphoreDelete(gate->lock);
+        gate->lock = NULL;
+        return ret;
+    }
+
+    if (is_on) {
+        esp_timer_start_once(gate->idle_timer, gate->idle_off_us);
+    }
+    ESP_LOGI(TAG, "Flip board supply goes off after %ld ms idle", idle_off_ms);
+    return ESP_OK;
+}
+
+esp_err_t flip_dot_supply_gate_acquire(flip_dot_supply_gate_t *gate) {
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(gate->lock, portMAX_DELAY);
+    if (gate->refs++ == 0) {
+        esp_timer_stop(gate->idle_timer);
+    }
+    if (!gate->on) {
+        // Other panels wait on the lock until the supply is up
+        ret = gate->enable();
+        if (ret == ESP_OK) {
+            gate->on = true;
+            gate->power_ups++;
+        } else {
+            // Not held, switched back off so the next acquire starts clean
+            ESP_LOGW(TAG, "Flip board supply not ready: %s", esp_err_to_name(ret));
+            gate->disable();
+            gate->refs--;
+        }
+    }
+    xSemaphoreGive(gate->lock);
+    return ret;
+}
+
+void flip_dot_supply_gate_release(flip_dot_supply_gate_t *gate) {
+    xSemaphoreTake(gate->lock, portMAX_DELAY);
+    if (gate->refs > 0 && --gate->refs == 0) {
+        esp_timer_start_once(gate->idle_timer, gate->idle_off_us);
+    }
+    xSemaphoreGive(gate->lock);
+}
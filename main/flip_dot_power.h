@@ -0,0 +1,75 @@
+/**
+ * @file flip_dot_power.h
+ * @brief Coil energy budget and idle gating of the flip board supply
+ *
+ * The energy budget is a token bucket over coil-on time, the part of a flip
+ * that draws from the supply. It allows max_on_us of pulses per window_us on
+ * average and bursts of up to one full window. Panels sharing a supply share
+ * one budget, a pulse that does not fit waits until enough has refilled.
+ *
+ * The supply gate switches the flip board off once no panel has pulsed for
+ * idle_off_ms and back on before the next pulse. Every panel with pulses in
+ * flight holds a reference, the supply only goes off when none does.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_DOT_POWER_H
+#define FLIP_DOT_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    portMUX_TYPE lock;
+    uint32_t max_on_us;         // Coil-on time allowed per window
+    uint32_t window_us;
+    int64_t level;              // Bucket level in us * window_us, refills at max_on_us per us
+    int64_t refilled_us;        // Time of the last refill
+} flip_dot_energy_budget_t;
+
+// Switches the supply, enable returns once the panel can be pulsed
+typedef esp_err_t (*flip_dot_supply_switch_t)(void);
+
+typedef struct {
+    SemaphoreHandle_t lock;     // Held across enable, which blocks
+    flip_dot_supply_switch_t enable;
+    flip_dot_supply_switch_t disable;
+    uint32_t idle_off_us;
+    esp_timer_handle_t idle_timer;
+    uint8_t refs;               // Panels with pulses in flight
+    bool on;
+    uint32_t power_ups;         // Times the supply was switched back on
+} flip_dot_supply_gate_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Starts with a full bucket
+void flip_dot_energy_budget_init(flip_dot_energy_budget_t *budget, uint32_t max_on_us, uint32_t window_us);
+
+// Takes pulse_us of coil-on time from the budget, returns 0 when granted or
+// the time to wait before asking again
+uint32_t flip_dot_energy_budget_take(flip_dot_energy_budget_t *budget, uint32_t pulse_us);
+
+// is_on tells whether the supply is already switched on, the idle timer then
+// starts right away
+esp_err_t flip_dot_supply_gate_init(flip_dot_supply_gate_t *gate, flip_dot_supply_switch_t enable,
+                                    flip_dot_supply_switch_t disable, uint32_t idle_off_ms, bool is_on);
+
+// Switches the supply on if needed and holds it on until the matching release.
+// On error the supply is left off and nothing is held, do not release.
+esp_err_t flip_dot_supply_gate_acquire(flip_dot_supply_gate_t *gate);
+void flip_dot_supply_gate_release(flip_dot_supply_gate_t *gate);
+
+#endif /* FLIP_DOT_POWER_H */
@@ -0,0 +1,269 @@
+/**
+ * @file flip_dot_render.c
+ * @brief Asynchronous render task for the flip dot display driver
+ *
+ * Producers hand frames to flip_dot_submit_frame() and return immediately.
+ * The render task owns the panel: it swaps the latest submitted frame into
+ * its front buffer and flips it while the next frame is being computed.
+ * Frames submitted while a flip sequence is running replace each other, so
+ * only the most recent one is ever drawn. With a flip budget set, the task
+ * checks for a newer frame between budget slices, so a long update never
+ * holds back the next one. A frame submitted with flip_dot_transition() is
+ * drawn as one timed job instead, frames submitted meanwhile wait for it.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "flip_dot.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_dot_render";
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static void flip_dot_render_task(void *arg);
+static void flip_dot_render_carry_over(flip_dot_t *display, uint16_t remaining);
+static void flip_dot_render_submit(flip_dot_t *display, const flip_dot_frame_t *frame,
+                                   flip_dot_transition_t effect, uint32_t duration_us);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static void flip_dot_render_task(void *arg) {
+    flip_dot_t *display = (flip_dot_t *)arg;
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    ESP_LOGI(TAG, "Render task running on core %d", xPortGetCoreID());
+
+    // Pulse timing runs on this core from here on, out of reach of WiFi bursts
+    pulse_engine_bind_to_current_core(&display->pulse_engine);
+    xSemaphoreGive(renderer->started);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (1) {
+            // Swap the latest submitted frame into the front buffer
+            portENTER_CRITICAL(&renderer->lock);
+            if (!renderer->pending) {
+                renderer->idle_us = esp_timer_get_time();
+                renderer->busy = false;
+                portEXIT_CRITICAL(&renderer->lock);
+                xSemaphoreGive(renderer->idle);
+                break;
+            }
+            renderer->front ^= 1;
+            renderer->pending = false;
+            renderer->busy = true;
+            portEXIT_CRITICAL(&renderer->lock);
+
+            uint8_t front = renderer->front;
+            if (renderer->transition[front] != FLIP_DOT_TRANSITION_CUT) {
+                flip_dot_draw_transition_stamped(display, &renderer->frames[front], renderer->transition[front],
+                                                 renderer->transition_us[front], renderer->submit_us[front]);
+            } else {
+                uint16_t remaining = flip_dot_update_display_stamped(display, &renderer->frames[front],
+                                                                     renderer->submit_us[front]);
+                flip_dot_render_carry_over(display, remaining);
+            }
+        }
+    }
+}
+
+// Works off what the flip budget left of a frame, one slice per tick. The
+// wait blocks, so the task never spins at its priority, and ends early when a
+// newer frame is submitted, which then replaces this one. While the flip board
+// supply is down the wait stretches to its retry backoff.
+static void flip_dot_render_carry_over(flip_dot_t *display, uint16_t remaining) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    while (remaining > 0) {
+        TickType_t wait = flip_dot_supply_retry_ticks(display);
+        if (renderer->task) {
+            ulTaskNotifyTake(pdTRUE, wait > FLIP_DOT_RENDER_SLICE_TICKS ? wait : FLIP_DOT_RENDER_SLICE_TICKS);
+        } else if (wait) {
+            // Drawing in the caller's task, leave the rest to the next update
+            return;
+        } else {
+            vTaskDelay(FLIP_DOT_RENDER_SLICE_TICKS);
+        }
+        if (renderer->pending) {
+            return;
+        }
+        remaining = flip_dot_service(display);
+    }
+}
+
+static void flip_dot_render_submit(flip_dot_t *display, const flip_dot_frame_t *frame,
+                                   flip_dot_transition_t effect, uint32_t duration_us) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    if (!renderer->task) {
+        // No render task, draw synchronously
+        if (effect == FLIP_DOT_TRANSITION_CUT) {
+            flip_dot_render_carry_over(display, flip_dot_update_display_packed(display, frame));
+        } else {
+            flip_dot_draw_transition(display, frame, effect, duration_us);
+        }
+        return;
+    }
+
+    // Overwrite the back buffer, an older frame that was never picked up is dropped
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&renderer->lock);
+    uint8_t back = renderer->front ^ 1;
+    if (renderer->pending) {
+        FLIP_DOT_STAT(display->stats.frames_coalesced++);
+    }
+    renderer->frames[back] = *frame;
+    renderer->submit_us[back] = now;
+    renderer->transition[back] = effect;
+    renderer->transition_us[back] = duration_us;
+    renderer->pending = true;
+    portEXIT_CRITICAL(&renderer->lock);
+
+    xTaskNotifyGive(renderer->task);
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t flip_dot_render_start(flip_dot_t *display, BaseType_t core_id, UBaseType_t priority) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    if (renderer->task) {
+        ESP_LOGW(TAG, "Render task already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portMUX_INITIALIZE(&renderer->lock);
+    renderer->front = 0;
+    renderer->pending = false;
+    renderer->busy = false;
+    renderer->frames[0] = display->pixel_state;
+    renderer->frames[1] = display->pixel_state;
+    renderer->transition[0] = FLIP_DOT_TRANSITION_CUT;
+    renderer->transition[1] = FLIP_DOT_TRANSITION_CUT;
+
+    renderer->started = xSemaphoreCreateBinary();
+    renderer->idle = xSemaphoreCreateBinary();
+    if (!renderer->started || !renderer->idle) {
+        if (renderer->started) {
+            vSemaphoreDelete(renderer->started);
+        }
+        if (renderer->idle) {
+            vSemaphoreDelete(renderer->idle);
+        }
+        renderer->started = NULL;
+        renderer->idle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t ret = xTaskCreatePinnedToCore(flip_dot_render_task, "flip_dot_render",
+                                             FLIP_DOT_RENDER_TASK_STACK_SIZE, display,
+                                             priority, &renderer->task, core_id);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create render task");
+        renderer->task = NULL;
+        vSemaphoreDelete(renderer->started);
+        vSemaphoreDelete(renderer->idle);
+        renderer->started = NULL;
+        renderer->idle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // The caller must not touch the panel while the pulse engine changes cores
+    if (xSemaphoreTake(renderer->started, pdMS_TO_TICKS(FLIP_DOT_RENDER_START_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Render task slow to start");
+    }
+
+    ESP_LOGI(TAG, "Render task started (core %d, priority %d)", core_id, priority);
+    return ESP_OK;
+}
+
+void flip_dot_submit_frame(flip_dot_t *display, const uint8_t data[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
+    flip_dot_frame_t frame;
+    flip_dot_frame_pack(&frame, data);
+    flip_dot_submit_frame_packed(display, &frame);
+}
+
+void flip_dot_submit_frame_packed(flip_dot_t *display, const flip_dot_frame_t *frame) {
+    flip_dot_render_submit(display, frame, FLIP_DOT_TRANSITION_CUT, 0);
+}
+
+// Like flip_dot_submit_frame_packed(), with the change drawn as a scene
+// transition spread over duration_us
+void flip_dot_transition(flip_dot_t *display, const flip_dot_frame_t *frame,
+                         flip_dot_transition_t effect, uint32_t duration_us) {
+    flip_dot_render_submit(display, frame, effect, duration_us);
+}
+
+// Applies a few dot changes on top of the latest submitted frame. Cheaper
+// than building and submitting a full frame when only a handful of dots move.
+void flip_dot_apply_changes(flip_dot_t *display, const flip_dot_change_t *changes, uint16_t count) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    if (!renderer->task) {
+        // No render task, draw synchronously
+        flip_dot_frame_t frame = display->target;
+        flip_dot_frame_apply_changes(&frame, changes, count);
+        flip_dot_render_carry_over(display, flip_dot_update_display_packed(display, &frame));
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&renderer->lock);
+    uint8_t back = renderer->front ^ 1;
+    if (renderer->pending) {
+        // Fold into the frame that is still waiting
+        FLIP_DOT_STAT(display->stats.frames_coalesced++);
+    } else {
+        // The front buffer is the latest frame, start from it
+        renderer->frames[back] = renderer->frames[renderer->front];
+        renderer->transition[back] = FLIP_DOT_TRANSITION_CUT;
+    }
+    flip_dot_frame_apply_changes(&renderer->frames[back], changes, count);
+    renderer->submit_us[back] = now;
+    renderer->pending = true;
+    portEXIT_CRITICAL(&renderer->lock);
+
+    xTaskNotifyGive(renderer->task);
+}
+
+bool flip_dot_render_is_idle(flip_dot_t *display) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+    return !renderer->pending && !renderer->busy;
+}
+
+// The semaphore may still hold the give of an earlier idle, so the state is
+// checked again after every take
+bool flip_dot_render_wait_idle(flip_dot_t *display, TickType_t timeout, int64_t *idle_us) {
+    flip_dot_renderer_t *renderer = &display->renderer;
+
+    if (!renderer->task) {
+        // Synchronous drawing, done once the submit returned
+        if (idle_us) {
+            *idle_us = esp_timer_get_time();
+        }
+        return true;
+    }
+    while (!flip_dot_render_is_idle(display)) {
+        if (xSemaphoreTake(renderer->idle, timeout) != pdTRUE) {
+            return false;
+        }
+    }
+    if (idle_us) {
+        *idle_us = renderer->idle_us;
+    }
+    return true;
+}
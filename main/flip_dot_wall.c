@@ -0,0 +1,107 @@
+/**
+ * @file flip_dot_wall.c
+ * @brief Several flip dot panels driven as one wall
+ *
+ * Panels draw in parallel because nothing is shared between them but the
+ * GPIO output registers and the supply. Address writes go through W1TS/W1TC,
+ * which only touch the bits written, so render tasks on different panels
+ * never undo each other's lines. The supply is shared through the pulse
+ * token pool.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "flip_dot_wall.h"
+#include <string.h>
+#include "esp_log.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "flip_dot_wall";
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t flip_dot_wall_init(flip_dot_wall_t *wall, const flip_dot_wall_config_t *config) {
+    if (config->panel_count == 0 || config->panel_count > FLIP_DOT_WALL_MAX_PANELS) {
+        ESP_LOGE(TAG, "%d panels, CONFIG_FLIP_DOT_MAX_PANELS allows 1 to %d", config->panel_count,
+                 FLIP_DOT_WALL_MAX_PANELS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->panels_per_row == 0 || config->panel_count % config->panels_per_row != 0) {
+        ESP_LOGE(TAG, "%d panels don't fill rows of %d", config->panel_count, config->panels_per_row);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Panels pulse independently, a shared line would corrupt both addresses
+    uint64_t used = 0;
+    for (uint8_t i = 0; i < config->panel_count; i++) {
+        uint64_t mask = flip_dot_pins_mask(&config->pins[i]);
+        if (used & mask) {
+            ESP_LOGE(TAG, "Panel %d shares GPIOs with another panel", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        used |= mask;
+    }
+
+    memset(wall, 0, sizeof(*wall));
+    wall->panel_count = config->panel_count;
+    wall->panels_per_row = config->panels_per_row;
+    wall->width = config->panels_per_row * DISPLAY_WIDTH;
+    wall->height = (config->panel_count / config->panels_per_row) * DISPLAY_HEIGHT;
+
+    if (config->max_concurrent_pulses && config->max_concurrent_pulses < config->panel_count) {
+        wall->power_tokens = xSemaphoreCreateCounting(config->max_concurrent_pulses, config->max_concurrent_pulses);
+        if (!wall->power_tokens) {
+            ESP_LOGE(TAG, "Failed to create pulse token pool");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (uint8_t i = 0; i < wall->panel_count; i++) {
+        flip_dot_init_with_pins(&wall->panels[i], &config->pins[i], config->flip_time_us, config->sweep_mode);
+        flip_dot_set_power_tokens(&wall->panels[i], wall->power_tokens);
+        flip_dot_set_energy_budget(&wall->panels[i], config->energy_budget);
+        flip_dot_set_supply_gate(&wall->panels[i], config->supply_gate);
+    }
+
+    ESP_LOGI(TAG, "Wall of %d panels, %dx%d dots, %d pulses at once", wall->panel_count, wall->width, wall->height,
+             wall->power_tokens ? config->max_concurrent_pulses : wall->panel_count);
+    return ESP_OK;
+}
+
+void flip_dot_wall_clear_display_fast(flip_dot_wall_t *wall) {
+    for (uint8_t i = 0; i < wall->panel_count; i++) {
+        flip_dot_clear_display_fast(&wall->panels[i]);
+    }
+}
+
+esp_err_t flip_dot_wall_render_start(flip_dot_wall_t *wall, BaseType_t core_id, UBaseType_t priority) {
+    for (uint8_t i = 0; i < wall->panel_count; i++) {
+        esp_err_t ret = flip_dot_render_start(&wall->panels[i], core_id, priority);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Render task of panel %d not started", i);
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+void flip_dot_wall_submit_frame(flip_dot_wall_t *wall, const flip_dot_wall_frame_t *frame) {
+    for (uint8_t i = 0; i < wall->panel_count; i++) {
+        flip_dot_submit_frame_packed(&wall->panels[i], &frame->panels[i]);
+    }
+}
+
+bool flip_dot_wall_is_idle(flip_dot_wall_t *wall) {
+    for (uint8_t i = 0; i < wall->panel_count; i++) {
+        if (!flip_dot_render_is_idle(&wall->panels[i])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file flip_dot_wall.h
+ * @brief Several flip dot panels driven as one wall
+ *
+ * Each panel is a normal flip_dot_t on its own set of demux and enable GPIOs,
+ * with its own pulse engine and render task. A wall frame is split into one
+ * packed frame per panel and every panel draws its part at the same time, so
+ * the flip rate scales with the panel count. Pulses on all panels share one
+ * power budget, at most max_concurrent_pulses coils are on at once.
+ *
+ * Panels are laid out in rows of panels_per_row, left to right and top to
+ * bottom. Wall coordinates run over the whole wall, (0, 0) top left.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FLIP_DOT_WALL_H
+#define FLIP_DOT_WALL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define FLIP_DOT_WALL_MAX_PANELS CONFIG_FLIP_DOT_MAX_PANELS
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    uint8_t panel_count;
+    uint8_t panels_per_row;             // panel_count must be a multiple of it
+    const flip_dot_pins_t *pins;        // panel_count entries, no pin may be shared
+    uint32_t flip_time_us;
+    sweep_mode_t sweep_mode;
+    uint8_t max_concurrent_pulses;      // Power budget, 0 lets every panel pulse at once
+    flip_dot_energy_budget_t *energy_budget;  // Coil-on budget of the shared supply, NULL for none
+    flip_dot_supply_gate_t *supply_gate;      // Idle gating of the shared supply, NULL for always on
+} flip_dot_wall_config_t;
+
+// Wall framebuffer, one packed frame per panel
+typedef struct {
+    flip_dot_frame_t panels[FLIP_DOT_WALL_MAX_PANELS];
+} flip_dot_wall_frame_t;
+
+typedef struct {
+    flip_dot_t panels[FLIP_DOT_WALL_MAX_PANELS];
+    uint8_t panel_count;
+    uint8_t panels_per_row;
+    uint16_t width;                     // Wall size in dots
+    uint16_t height;
+    SemaphoreHandle_t power_tokens;     // NULL when the budget doesn't limit anything
+} flip_dot_wall_t;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Initializes every panel. Per panel settings (pipelining, adaptive timing)
+// go through wall->panels[i] before the render tasks start.
+esp_err_t flip_dot_wall_init(flip_dot_wall_t *wall, const flip_dot_wall_config_t *config);
+
+// Boot clear of every panel, one after the other
+void flip_dot_wall_clear_display_fast(flip_dot_wall_t *wall);
+
+// One render task per panel, all on the given core
+esp_err_t flip_dot_wall_render_start(flip_dot_wall_t *wall, BaseType_t core_id, UBaseType_t priority);
+
+// Hands every panel its part of the frame, the panels then draw in parallel
+void flip_dot_wall_submit_frame(flip_dot_wall_t *wall, const flip_dot_wall_frame_t *frame);
+bool flip_dot_wall_is_idle(flip_dot_wall_t *wall);
+
+static inline void flip_dot_wall_frame_clear(flip_dot_wall_frame_t *frame) {
+    for (uint8_t i = 0; i < FLIP_DOT_WALL_MAX_PANELS; i++) {
+        flip_dot_frame_clear(&frame->panels[i]);
+    }
+}
+
+// Out of range coordinates are ignored
+static inline void flip_dot_wall_frame_set(const flip_dot_wall_t *wall, flip_dot_wall_frame_t *frame,
+                                           uint16_t x, uint16_t y, bool value) {
+    if (x >= wall->width || y >= wall->height) {
+        return;
+    }
+    uint8_t panel = (y / DISPLAY_HEIGHT) * wall->panels_per_row + x / DISPLAY_WIDTH;
+    flip_dot_frame_set(&frame->panels[panel], y % DISPLAY_HEIGHT, x % DISPLAY_WIDTH, value);
+}
+
+static inline bool flip_dot_wall_frame_get(const flip_dot_wall_t *wall, const flip_dot_wall_frame_t *frame,
+                                           uint16_t x, uint16_t y) {
+    if (x >= wall->width || y >= wall->height) {
+        return false;
+    }
+    uint8_t panel = (y / DISPLAY_HEIGHT) * wall->panels_per_row + x / DISPLAY_WIDTH;
+    return flip_dot_frame_get(&frame->panels[panel], y % DISPLAY_HEIGHT, x % DISPLAY_WIDTH);
+}
+
+#endif /* FLIP_DOT_WALL_H */
@@ -0,0 +1,312 @@
+/**
+ * @file font.c
+ * @brief Flash-resident bitmap fonts and a column-blit text engine
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "font.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+// Classic 5x7, column bytes with bit 0 at the top
+static const uint8_t font_5x7_columns[FONT_CHAR_COUNT * 5] = {
+    0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+    0x00, 0x00, 0x5F, 0x00, 0x00,  // '!'
+    0x00, 0x07, 0x00, 0x07, 0x00,  // '"'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,  // '#'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,  // '$'
+    0x23, 0x13, 0x08, 0x64, 0x62,  // '%'
+    0x36, 0x49, 0x55, 0x22, 0x50,  // '&'
+    0x00, 0x05, 0x03, 0x00, 0x00,  // '\''
+    0x00, 0x1C, 0x22, 0x41, 0x00,  // '('
+    0x00, 0x41, 0x22, 0x1C, 0x00,  // ')'
+    0x14, 0x08, 0x3E, 0x08, 0x14,  // '*'
+    0x08, 0x08, 0x3E, 0x08, 0x08,  // '+'
+    0x00, 0x50, 0x30, 0x00, 0x00,  // ','
+    0x08, 0x08, 0x08, 0x08, 0x08,  // '-'
+    0x00, 0x60, 0x60, 0x00, 0x00,  // '.'
+    0x20, 0x10, 0x08, 0x04, 0x02,  // '/'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,  // '0'
+    0x00, 0x42, 0x7F, 0x40, 0x00,  // '1'
+    0x42, 0x61, 0x51, 0x49, 0x46,  // '2'
+    0x21, 0x41, 0x45, 0x4B, 0x31,  // '3'
+    0x18, 0x14, 0x12, 0x7F, 0x10,  // '4'
+    0x27, 0x45, 0x45, 0x45, 0x39,  // '5'
+    0x3C, 0x4A, 0x49, 0x49, 0x30,  // '6'
+    0x01, 0x71, 0x09, 0x05, 0x03,  // '7'
+    0x36, 0x49, 0x49, 0x49, 0x36,  // '8'
+    0x06, 0x49, 0x49, 0x29, 0x1E,  // '9'
+    0x00, 0x36, 0x36, 0x00, 0x00,  // ':'
+    0x00, 0x56, 0x36, 0x00, 0x00,  // ';'
+    0x08, 0x14, 0x22, 0x41, 0x00,  // '<'
+    0x14, 0x14, 0x14, 0x14, 0x14,  // '='
+    0x00, 0x41, 0x22, 0x14, 0x08,  // '>'
+    0x02, 0x01, 0x51, 0x09, 0x06,  // '?'
+    0x32, 0x49, 0x79, 0x41, 0x3E,  // '@'
+    0x7E, 0x11, 0x11, 0x11, 0x7E,  // 'A'
+    0x7F, 0x49, 0x49, 0x49, 0x36,  // 'B'
+    0x3E, 0x41, 0x41, 0x41, 0x22,  // 'C'
+    0x7F, 0x41, 0x41, 0x22, 0x1C,  // 'D'
+    0x7F, 0x49, 0x49, 0x49, 0x41,  // 'E'
+    0x7F, 0x09, 0x09, 0x09, 0x01,  // 'F'
+    0x3E, 0x41, 0x49, 0x49, 0x7A,  // 'G'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,  // 'H'
+    0x00, 0x41, 0x7F, 0x41, 0x00,  // 'I'
+    0x20, 0x40, 0x41, 0x3F, 0x01,  // 'J'
+    0x7F, 0x08, 0x14, 0x22, 0x41,  // 'K'
+    0x7F, 0x40, 0x40, 0x40, 0x40,  // 'L'
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,  // 'M'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,  // 'N'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,  // 'O'
+    0x7F, 0x09, 0x09, 0x09, 0x06,  // 'P'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,  // 'Q'
+    0x7F, 0x09, 0x19, 0x29, 0x46,  // 'R'
+    0x46, 0x49, 0x49, 0x49, 0x31,  // 'S'
+    0x01, 0x01, 0x7F, 0x01, 0x01,  // 'T'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,  // 'U'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,  // 'V'
+    0x3F, 0x40, 0x38, 0x40, 0x3F,  // 'W'
+    0x63, 0x14, 0x08, 0x14, 0x63,  // 'X'
+    0x07, 0x08, 0x70, 0x08, 0x07,  // 'Y'
+    0x61, 0x51, 0x49, 0x45, 0x43,  // 'Z'
+    0x00, 0x7F, 0x41, 0x41, 0x00,  // '['
+    0x02, 0x04, 0x08, 0x10, 0x20,  // '\\'
+    0x00, 0x41, 0x41, 0x7F, 0x00,  // ']'
+    0x04, 0x02, 0x01, 0x02, 0x04,  // '^'
+    0x40, 0x40, 0x40, 0x40, 0x40,  // '_'
+    0x00, 0x01, 0x02, 0x04, 0x00,  // '`'
+    0x20, 0x54, 0x54, 0x54, 0x78,  // 'a'
+    0x7F, 0x48, 0x44, 0x44, 0x38,  // 'b'
+    0x38, 0x44, 0x44, 0x44, 0x20,  // 'c'
+    0x38, 0x44, 0x44, 0x48, 0x7F,  // 'd'
+    0x38, 0x54, 0x54, 0x54, 0x18,  // 'e'
+    0x08, 0x7E, 0x09, 0x01, 0x02,  // 'f'
+    0x0C, 0x52, 0x52, 0x52, 0x3E,  // 'g'
+    0x7F, 0x08, 0x04, 0x04, 0x78,  // 'h'
+    0x00, 0x44, 0x7D, 0x40, 0x00,  // 'i'
+    0x20, 0x40, 0x44, 0x3D, 0x00,  // 'j'
+    0x7F, 0x10, 0x28, 0x44, 0x00,  // 'k'
+    0x00, 0x41, 0x7F, 0x40, 0x00,  // 'l'
+    0x7C, 0x04, 0x18, 0x04, 0x78,  // 'm'
+    0x7C, 0x08, 0x04, 0x04, 0x78,  // 'n'
+    0x38, 0x44, 0x44, 0x44, 0x38,  // 'o'
+    0x7C, 0x14, 0x14, 0x14, 0x08,  // 'p'
+    0x08, 0x14, 0x14, 0x18, 0x7C,  // 'q'
+    0x7C, 0x08, 0x04, 0x04, 0x08,  // 'r'
+    0x48, 0x54, 0x54, 0x54, 0x20,  // 's'
+    0x04, 0x3F, 0x44, 0x40, 0x20,  // 't'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,  // 'u'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,  // 'v'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,  // 'w'
+    0x44, 0x28, 0x10, 0x28, 0x44,  // 'x'
+    0x0C, 0x50, 0x50, 0x50, 0x3C,  // 'y'
+    0x44, 0x64, 0x54, 0x4C, 0x44,  // 'z'
+    0x00, 0x08, 0x36, 0x41, 0x00,  // '{'
+    0x00, 0x00, 0x7F, 0x00, 0x00,  // '|'
+    0x00, 0x41, 0x36, 0x08, 0x00,  // '}'
+    0x10, 0x08, 0x08, 0x10, 0x08,  // '~'
+};
+
+// 3x5 for status text, lower case drawn as small letters in rows 1-4
+static const uint8_t font_3x5_columns[FONT_CHAR_COUNT * 3] = {
+    0x00, 0x00, 0x00,  // ' '
+    0x00, 0x17, 0x00,  // '!'
+    0x03, 0x00, 0x03,  // '"'
+    0x1F, 0x0A, 0x1F,  // '#'
+    0x12, 0x1F, 0x09,  // '$'
+    0x09, 0x04, 0x12,  // '%'
+    0x0A, 0x15, 0x1A,  // '&'
+    0x00, 0x03, 0x00,  // '\''
+    0x00, 0x0E, 0x11,  // '('
+    0x11, 0x0E, 0x00,  // ')'
+    0x05, 0x02, 0x05,  // '*'
+    0x04, 0x0E, 0x04,  // '+'
+    0x10, 0x08, 0x00,  // ','
+    0x04, 0x04, 0x04,  // '-'
+    0x00, 0x10, 0x00,  // '.'
+    0x18, 0x04, 0x03,  // '/'
+    0x1F, 0x11, 0x1F,  // '0'
+    0x12, 0x1F, 0x10,  // '1'
+    0x19, 0x15, 0x12,  // '2'
+    0x11, 0x15, 0x0A,  // '3'
+    0x07, 0x04, 0x1F,  // '4'
+    0x17, 0x15, 0x09,  // '5'
+    0x1E, 0x15, 0x1D,  // '6'
+    0x01, 0x1D, 0x03,  // '7'
+    0x1F, 0x15, 0x1F,  // '8'
+    0x17, 0x15, 0x0F,  // '9'
+    0x00, 0x0A, 0x00,  // ':'
+    0x10, 0x0A, 0x00,  // ';'
+    0x04, 0x0A, 0x11,  // '<'
+    0x0A, 0x0A, 0x0A,  // '='
+    0x11, 0x0A, 0x04,  // '>'
+    0x01, 0x15, 0x02,  // '?'
+    0x0E, 0x15, 0x16,  // '@'
+    0x1E, 0x05, 0x1E,  // 'A'
+    0x1F, 0x15, 0x0A,  // 'B'
+    0x0E, 0x11, 0x11,  // 'C'
+    0x1F, 0x11, 0x0E,  // 'D'
+    0x1F, 0x15, 0x11,  // 'E'
+    0x1F, 0x05, 0x01,  // 'F'
+    0x0E, 0x11, 0x1D,  // 'G'
+    0x1F, 0x04, 0x1F,  // 'H'
+    0x11, 0x1F, 0x11,  // 'I'
+    0x08, 0x10, 0x0F,  // 'J'
+    0x1F, 0x04, 0x1B,  // 'K'
+    0x1F, 0x10, 0x10,  // 'L'
+    0x1F, 0x06, 0x1F,  // 'M'
+    0x1F, 0x01, 0x1E,  // 'N'
+    0x0E, 0x11, 0x0E,  // 'O'
+    0x1F, 0x05, 0x02,  // 'P'
+    0x0E, 0x19, 0x1E,  // 'Q'
+    0x1F, 0x05, 0x1A,  // 'R'
+    0x12, 0x15, 0x09,  // 'S'
+    0x01, 0x1F, 0x01,  // 'T'
+    0x0F, 0x10, 0x1F,  // 'U'
+    0x07, 0x18, 0x07,  // 'V'
+    0x1F, 0x0C, 0x1F,  // 'W'
+    0x1B, 0x04, 0x1B,  // 'X'
+    0x03, 0x1C, 0x03,  // 'Y'
+    0x19, 0x15, 0x13,  // 'Z'
+    0x1F, 0x11, 0x00,  // '['
+    0x03, 0x04, 0x18,  // '\\'
+    0x00, 0x11, 0x1F,  // ']'
+    0x02, 0x01, 0x02,  // '^'
+    0x10, 0x10, 0x10,  // '_'
+    0x01, 0x02, 0x00,  // '`'
+    0x0A, 0x16, 0x1C,  // 'a'
+    0x1F, 0x12, 0x0C,  // 'b'
+    0x0C, 0x12, 0x12,  // 'c'
+    0x0C, 0x12, 0x1F,  // 'd'
+    0x0C, 0x16, 0x14,  // 'e'
+    0x04, 0x1E, 0x05,  // 'f'
+    0x14, 0x1A, 0x0E,  // 'g'
+    0x1F, 0x02, 0x1C,  // 'h'
+    0x00, 0x1D, 0x00,  // 'i'
+    0x08, 0x10, 0x0D,  // 'j'
+    0x1F, 0x0C, 0x12,  // 'k'
+    0x11, 0x1F, 0x10,  // 'l'
+    0x1E, 0x06, 0x1E,  // 'm'
+    0x1E, 0x02, 0x1C,  // 'n'
+    0x0C, 0x12, 0x0C,  // 'o'
+    0x1E, 0x0A, 0x04,  // 'p'
+    0x04, 0x0A, 0x1E,  // 'q'
+    0x1C, 0x02, 0x02,  // 'r'
+    0x10, 0x16, 0x0A,  // 's'
+    0x02, 0x1F, 0x12,  // 't'
+    0x0E, 0x10, 0x1E,  // 'u'
+    0x06, 0x18, 0x06,  // 'v'
+    0x1E, 0x18, 0x1E,  // 'w'
+    0x12, 0x0C, 0x12,  // 'x'
+    0x16, 0x08, 0x06,  // 'y'
+    0x1A, 0x16, 0x12,  // 'z'
+    0x04, 0x1F, 0x11,  // '{'
+    0x00, 0x1F, 0x00,  // '|'
+    0x11, 0x1F, 0x04,  // '}'
+    0x04, 0x06, 0x02,  // '~'
+};
+
+const font_t font_5x7 = {
+    .width = 5,
+    .height = 7,
+    .spacing = 1,
+    .columns = font_5x7_columns,
+};
+
+const font_t font_3x5 = {
+    .width = 3,
+    .height = 5,
+    .spacing = 1,
+    .columns = font_3x5_columns,
+};
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static const uint8_t *font_glyph(const font_t *font, char c) {
+    if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+        c = '?';
+    }
+    return &font->columns[(uint8_t)(c - FONT_FIRST_CHAR) * font->width];
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+uint8_t font_glyph_column(const font_t *font, char c, uint8_t col) {
+    if (col >= font->width) {
+        return 0;
+    }
+    return font_glyph(font, c)[col];
+}
+
+uint16_t font_text_width(const font_t *font, const char *text) {
+    uint16_t width = 0;
+    for (const char *p = text; *p; p++) {
+        width += font->width + font->spacing;
+    }
+    return width;
+}
+
+int16_t font_draw_text(flip_dot_frame_t *frame, const font_t *font, const char *text, int16_t x, int16_t y) {
+    for (const char *p = text; *p && x < DISPLAY_WIDTH; p++) {
+        const uint8_t *glyph = font_glyph(font, *p);
+        for (uint8_t col = 0; col < font->width; col++, x++) {
+            if (x < 0 || x >= DISPLAY_WIDTH || glyph[col] == 0) {
+                continue;
+            }
+            // One OR per set bit of the column, rows outside the frame are skipped
+            for (uint8_t row = 0; row < font->height; row++) {
+                int16_t frame_row = y + row;
+                if ((glyph[col] >> row) & 1 && frame_row >= 0 && frame_row < DISPLAY_HEIGHT) {
+                    frame->rows[frame_row] |= 1UL << x;
+                }
+            }
+        }
+        x += font->spacing;
+    }
+    return x;
+}
+
+void font_scroller_init(font_scroller_t *scroller, const font_t *font, const char *text, uint8_t top_row) {
+    scroller->font = font;
+    scroller->text = text;
+    scroller->top_row = top_row;
+    scroller->char_index = 0;
+    scroller->char_col = 0;
+}
+
+bool font_scroller_step(font_scroller_t *scroller, flip_dot_frame_t *frame) {
+    const font_t *font = scroller->font;
+    char c = scroller->text[scroller->char_index];
+    uint8_t bits = 0;
+
+    if (c != '\0') {
+        bits = font_glyph_column(font, c, scroller->char_col);
+        if (++scroller->char_col >= font->width + font->spacing) {
+            scroller->char_col = 0;
+            scroller->char_index++;
+        }
+    }
+
+    // Column 0 is the left edge, shifting right in the word moves dots left
+    for (uint8_t row = 0; row < font->height; row++) {
+        uint8_t frame_row = scroller->top_row + row;
+        if (frame_row >= DISPLAY_HEIGHT) {
+            break;
+        }
+        uint32_t word = frame->rows[frame_row] >> 1;
+        if ((bits >> row) & 1) {
+            word |= 1UL << (DISPLAY_WIDTH - 1);
+        }
+        frame->rows[frame_row] = word;
+    }
+
+    return scroller->text[scroller->char_index] != '\0';
+}
@@ -0,0 +1,77 @@
+/**
+ * @file font.h
+ * @brief Flash-resident bitmap fonts and a column-blit text engine
+ *
+ * Glyphs are stored column-major, one byte per column with bit 0 as the top
+ * row, covering printable ASCII (0x20-0x7E). Characters outside the table
+ * draw as '?'.
+ *
+ * The scroller feeds text into the right edge of a packed frame one column
+ * at a time: each step shifts the text band left by one dot and blits only
+ * the new column, so the driver sees a minimal dot diff.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "flip_dot.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR '~'
+#define FONT_CHAR_COUNT (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1)
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+typedef struct {
+    uint8_t width;              // Columns per glyph
+    uint8_t height;             // Rows per glyph, at most 8
+    uint8_t spacing;            // Blank columns after each glyph
+    const uint8_t *columns;     // FONT_CHAR_COUNT * width column bytes
+} font_t;
+
+// Streams the columns of a string into a packed frame from the right edge
+typedef struct {
+    const font_t *font;
+    const char *text;
+    uint8_t top_row;            // Frame row of the glyph's top row
+    size_t char_index;          // Character being fed in
+    uint8_t char_col;           // Next column of that character, spacing included
+} font_scroller_t;
+
+extern const font_t font_5x7;
+extern const font_t font_3x5;
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Column bits of one glyph column, bit 0 is the top row
+uint8_t font_glyph_column(const font_t *font, char c, uint8_t col);
+
+// Width in columns of a string including the spacing after each glyph
+uint16_t font_text_width(const font_t *font, const char *text);
+
+// Draws a string with its top-left corner at (x, y), clipped to the frame.
+// Returns the column after the last glyph.
+int16_t font_draw_text(flip_dot_frame_t *frame, const font_t *font, const char *text, int16_t x, int16_t y);
+
+void font_scroller_init(font_scroller_t *scroller, const font_t *font, const char *text, uint8_t top_row);
+
+// Shifts the text band of the frame one column left and blits the next text
+// column at the right edge. Returns false once the text has been fed in
+// completely, further steps feed blank columns.
+bool font_scroller_step(font_scroller_t *scroller, flip_dot_frame_t *frame);
+
+#endif /* FONT_H */
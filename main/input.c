@@ -13,6 +13,7 @@
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 /******************************************************************************
  * Private Definitions and Types
@@ -23,67 +24,262 @@ static const char *TAG = "input_system";
 // Buffer sizes
 #define UART_RX_BUF_SIZE 1024
 #define UART_TX_BUF_SIZE 1024
+#define UART_READ_CHUNK 128
+
+#define INPUT_ESC_CHAR '\x1b'
+
+// Raw byte hook, e.g. the trace dump key
+static input_serial_byte_handler_t g_serial_byte_handler = NULL;
+static void *g_serial_byte_handler_ctx = NULL;
 
 /******************************************************************************
  * Private Function Declarations
  ******************************************************************************/
 
-static void process_serial_char(input_system_t *input_sys, char c);
-static void process_arrow_sequence(input_system_t *input_sys, const char *seq);
+static void process_serial_command(input_system_t *input_sys, input_command_t command);
+static void process_arrow_final(input_system_t *input_sys, uint8_t c);
+static void input_serial_parse_byte(input_system_t *input_sys, uint8_t c);
+static void input_serial_task(void *arg);
 static uint32_t get_timestamp_ms(void);
+static input_event_queue_t *input_queue_for(input_system_t *input_sys, input_type_t type);
+static bool input_queue_push(input_event_queue_t *queue, const input_event_t *event);
+static const input_event_t *input_queue_peek(input_event_queue_t *queue);
+static bool input_queue_pop(input_event_queue_t *queue, input_event_t *event);
+static input_event_queue_t *input_queue_oldest(input_system_t *input_sys);
+static void input_dispatch_events(input_system_t *input_sys);
 
 /******************************************************************************
  * Private Function Implementations
  ******************************************************************************/
 
-static void process_serial_char(input_system_t *input_sys, char c) {
-    input_command_t command = input_char_to_command(c);
+static void process_serial_command(input_system_t *input_sys, input_command_t command) {
+    if (command == INPUT_CMD_NONE) {
+        return;
+    }
+    
+    send_input_event(input_sys, command, INPUT_TYPE_SERIAL);
+    
+    // Echo through the TX ring, printf would hold the serial task on the console
+    if (input_sys->config.serial_config.echo_enabled) {
+        char echo[24];
+        int len = snprintf(echo, sizeof(echo), "Input: %s\n", input_command_to_string(command));
+        uart_write_bytes(input_sys->config.serial_config.uart_num, echo, len);
+    }
+}
+
+static void process_arrow_final(input_system_t *input_sys, uint8_t c) {
+    switch (c) {
+        case INPUT_ARROW_UP_FINAL:
+            process_serial_command(input_sys, INPUT_CMD_UP);
+            break;
+        case INPUT_ARROW_DOWN_FINAL:
+            process_serial_command(input_sys, INPUT_CMD_DOWN);
+            break;
+        case INPUT_ARROW_LEFT_FINAL:
+            process_serial_command(input_sys, INPUT_CMD_LEFT);
+            break;
+        case INPUT_ARROW_RIGHT_FINAL:
+            process_serial_command(input_sys, INPUT_CMD_RIGHT);
+            break;
+        default:
+            break;  // Some other key, e.g. Home or F1
+    }
+}
+
+// One byte through the escape sequence state machine. The state lives in
+// input_sys, so a sequence may arrive over any number of reads.
+static void input_serial_parse_byte(input_system_t *input_sys, uint8_t c) {
+    switch (input_sys->esc_state) {
+        case INPUT_ESC_IDLE:
+            if (c == INPUT_ESC_CHAR) {
+                input_sys->esc_state = INPUT_ESC_START;
+            } else if (c >= 32 && c <= 126) {  // Printable ASCII
+                process_serial_command(input_sys, input_char_to_command((char)c));
+            }
+            break;
+            
+        case INPUT_ESC_START:
+            if (c == '[') {
+                input_sys->esc_state = INPUT_ESC_CSI;
+            } else if (c == 'O') {
+                input_sys->esc_state = INPUT_ESC_SS3;
+            } else {
+                // A lone ESC, the byte after it is a key of its own
+                input_sys->esc_state = INPUT_ESC_IDLE;
+                input_serial_parse_byte(input_sys, c);
+            }
+            break;
+            
+        case INPUT_ESC_CSI:
+            // Parameter and intermediate bytes run until the final byte
+            if (c >= 0x20 && c <= 0x3F) {
+                break;
+            }
+            input_sys->esc_state = INPUT_ESC_IDLE;
+            process_arrow_final(input_sys, c);
+            break;
+            
+        case INPUT_ESC_SS3:
+            input_sys->esc_state = INPUT_ESC_IDLE;
+            process_arrow_final(input_sys, c);
+            break;
+    }
+}
+
+// Sleeps on the UART driver's event queue, so bytes are parsed as soon as the
+// driver's RX interrupt has them, not when the game loop gets around to it
+static void input_serial_task(void *arg) {
+    input_system_t *input_sys = (input_system_t *)arg;
+    uart_port_t uart_num = input_sys->config.serial_config.uart_num;
+    uint8_t data[UART_READ_CHUNK];
+    uart_event_t event;
     
-    if (command != INPUT_CMD_NONE) {
-        send_input_event(input_sys, command, INPUT_TYPE_SERIAL);
+    while (1) {
+        if (xQueueReceive(input_sys->uart_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
         
-        // Echo the command if echo is enabled
-        if (input_sys->config.serial_config.echo_enabled) {
-            const char* cmd_str = input_command_to_string(command);
-            printf("Input: %s\n", cmd_str);
+        switch (event.type) {
+            case UART_DATA: {
+                size_t pending = event.size;
+                while (pending > 0) {
+                    int length = uart_read_bytes(uart_num, data,
+                                                 pending < sizeof(data) ? pending : sizeof(data), 0);
+                    if (length <= 0) {
+                        break;
+                    }
+                    input_serial_feed(input_sys, data, length);
+                    pending -= length;
+                }
+                break;
+            }
+                
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // Bytes are already lost, start over from a clean buffer
+                input_sys->serial_overflows++;
+                ESP_LOGW(TAG, "UART%d receive overflow, input flushed", uart_num);
+                uart_flush_input(uart_num);
+                xQueueReset(input_sys->uart_queue);
+                input_sys->esc_state = INPUT_ESC_IDLE;
+                break;
+                
+            default:
+                break;
         }
     }
 }
 
-static void process_arrow_sequence(input_system_t *input_sys, const char *seq) {
-    input_command_t command = INPUT_CMD_NONE;
+// Queues the event for the consumer task. Safe to call from the ESP-NOW
+// receive callback, it only copies the event and never blocks or logs.
+void send_input_event(input_system_t *input_sys, input_command_t command, input_type_t type) {
+    input_event_t event = {
+        .type = type,
+        .command = command,
+        .timestamp = get_timestamp_ms(),
+        .is_pressed = true,
+        .value = 0
+    };
     
-    if (strcmp(seq, INPUT_ARROW_UP_SEQ) == 0) {
-        command = INPUT_CMD_UP;
-    } else if (strcmp(seq, INPUT_ARROW_DOWN_SEQ) == 0) {
-        command = INPUT_CMD_DOWN;
-    } else if (strcmp(seq, INPUT_ARROW_LEFT_SEQ) == 0) {
-        command = INPUT_CMD_LEFT;
-    } else if (strcmp(seq, INPUT_ARROW_RIGHT_SEQ) == 0) {
-        command = INPUT_CMD_RIGHT;
+    input_event_queue_t *queue = input_queue_for(input_sys, type);
+    if (!queue) {
+        return;
     }
     
-    if (command != INPUT_CMD_NONE) {
-        send_input_event(input_sys, command, INPUT_TYPE_SERIAL);
-        
-        if (input_sys->config.serial_config.echo_enabled) {
-            const char* cmd_str = input_command_to_string(command);
-            printf("Arrow Input: %s\n", cmd_str);
+    if (input_queue_push(queue, &event) && input_sys->notify_task) {
+        xTaskNotify(input_sys->notify_task, input_sys->notify_bits, eSetBits);
+    }
+}
+
+// The ring of the producer behind this input type
+static input_event_queue_t *input_queue_for(input_system_t *input_sys, input_type_t type) {
+    switch (type) {
+        case INPUT_TYPE_SERIAL:
+            return &input_sys->event_queues[INPUT_PRODUCER_SERIAL];
+        case INPUT_TYPE_ESPNOW:
+            return &input_sys->event_queues[INPUT_PRODUCER_ESPNOW];
+        default:
+            return NULL;
+    }
+}
+
+// Producer side, publishes the slot with a release store on head
+static bool input_queue_push(input_event_queue_t *queue, const input_event_t *event) {
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    
+    if (head - tail >= INPUT_EVENT_QUEUE_SIZE) {
+        __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    
+    queue->events[head & (INPUT_EVENT_QUEUE_SIZE - 1)] = *event;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side, the oldest event or NULL when the ring is empty
+static const input_event_t *input_queue_peek(input_event_queue_t *queue) {
+    uint32_t tail = queue->tail;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    
+    if (head == tail) {
+        return NULL;
+    }
+    return &queue->events[tail & (INPUT_EVENT_QUEUE_SIZE - 1)];
+}
+
+// Consumer side, frees the slot with a release store on tail
+static bool input_queue_pop(input_event_queue_t *queue, input_event_t *event) {
+    uint32_t tail = queue->tail;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    
+    if (head == tail) {
+        return false;
+    }
+    
+    *event = queue->events[tail & (INPUT_EVENT_QUEUE_SIZE - 1)];
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// The ring whose next event is the oldest, so producers interleave in
+// arrival order
+static input_event_queue_t *input_queue_oldest(input_system_t *input_sys) {
+    input_event_queue_t *oldest = NULL;
+    const input_event_t *oldest_event = NULL;
+    
+    for (int p = 0; p < INPUT_PRODUCER_COUNT; p++) {
+        const input_event_t *event = input_queue_peek(&input_sys->event_queues[p]);
+        if (event && (!oldest_event || (int32_t)(event->timestamp - oldest_event->timestamp) < 0)) {
+            oldest = &input_sys->event_queues[p];
+            oldest_event = event;
         }
     }
+    return oldest;
 }
 
-void send_input_event(input_system_t *input_sys, input_command_t command, input_type_t type) {
-    if (input_sys->config.callback) {
-        input_event_t event = {
-            .type = type,
-            .command = command,
-            .timestamp = get_timestamp_ms(),
-            .is_pressed = true,
-            .value = 0
-        };
-        
-        input_sys->config.callback(&event);
+// Runs the callback for every queued event, in the calling task
+static void input_dispatch_events(input_system_t *input_sys) {
+    input_event_t event;
+    input_event_queue_t *queue;
+    while ((queue = input_queue_oldest(input_sys)) && input_queue_pop(queue, &event)) {
+        if (input_sys->config.callback) {
+            input_sys->config.callback(&event);
+        }
+    }
+    
+    uint32_t dropped = 0;
+    uint32_t rejected = 0;
+    for (int p = 0; p < INPUT_PRODUCER_COUNT; p++) {
+        dropped += __atomic_exchange_n(&input_sys->event_queues[p].dropped, 0, __ATOMIC_RELAXED);
+        rejected += __atomic_exchange_n(&input_sys->event_queues[p].rejected, 0, __ATOMIC_RELAXED);
+    }
+    if (dropped) {
+        ESP_LOGW(TAG, "Input queue full, dropped %ld events", dropped);
+    }
+    if (rejected) {
+        ESP_LOGW(TAG, "Rejected %ld malformed input packets", rejected);
     }
 }
 
@@ -110,40 +306,52 @@ esp_err_t input_system_init(input_system_t *input_sys, input_system_config_t *co
     input_sys->initialized = false;
     input_sys->serial_enabled = false;
     input_sys->espnow_enabled = false;
-    input_sys->rx_buffer_pos = 0;
-    memset(input_sys->rx_buffer, 0, sizeof(input_sys->rx_buffer));
+    memset(input_sys->event_queues, 0, sizeof(input_sys->event_queues));
+    input_sys->uart_queue = NULL;
+    input_sys->serial_task = NULL;
+    input_sys->esc_state = INPUT_ESC_IDLE;
+    input_sys->serial_overflows = 0;
+    input_sys->notify_task = NULL;
+    input_sys->notify_bits = 0;
+    
+    uint32_t supported = INPUT_TYPE_SERIAL | INPUT_TYPE_ESPNOW;
+    if (config->enabled_types == INPUT_TYPE_NONE || (config->enabled_types & ~supported)) {
+        ESP_LOGE(TAG, "Unsupported input types: 0x%lx", config->enabled_types);
+        return ESP_ERR_INVALID_ARG;
+    }
     
+    // Bring up every requested type, one that fails does not stop the others
     esp_err_t ret = ESP_OK;
+    if (config->enabled_types & INPUT_TYPE_SERIAL) {
+        esp_err_t serial_ret = input_serial_init(input_sys);
+        if (serial_ret == ESP_OK) {
+            input_sys->serial_enabled = true;
+        } else {
+            ESP_LOGW(TAG, "Serial input unavailable: %s", esp_err_to_name(serial_ret));
+            ret = serial_ret;
+        }
+    }
     
-    // Initialize the requested input type
-    switch (config->enabled_types) {
-        case INPUT_TYPE_SERIAL:
-            ret = input_serial_init(input_sys);
-            if (ret == ESP_OK) {
-                input_sys->serial_enabled = true;
-            }
-            break;
-            
-        case INPUT_TYPE_ESPNOW:
-            ret = input_espnow_init(input_sys);
-            if (ret == ESP_OK) {
-                input_sys->espnow_enabled = true;
-            }
-            break;
-            
-        default:
-            ESP_LOGE(TAG, "Unsupported input type: %d", config->enabled_types);
-            return ESP_ERR_INVALID_ARG;
+    if (config->enabled_types & INPUT_TYPE_ESPNOW) {
+        esp_err_t espnow_ret = input_espnow_init(input_sys);
+        if (espnow_ret == ESP_OK) {
+            input_sys->espnow_enabled = true;
+        } else {
+            ESP_LOGW(TAG, "ESP-NOW input unavailable: %s", esp_err_to_name(espnow_ret));
+            ret = espnow_ret;
+        }
     }
     
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize input type %d: %s", 
+    if (!input_sys->serial_enabled && !input_sys->espnow_enabled) {
+        ESP_LOGE(TAG, "Failed to initialize input types 0x%lx: %s", 
                  config->enabled_types, esp_err_to_name(ret));
         return ret;
     }
     
     input_sys->initialized = true;
-    ESP_LOGI(TAG, "Input system initialized successfully with type %d", config->enabled_types);
+    ESP_LOGI(TAG, "Input system initialized:%s%s",
+             input_sys->serial_enabled ? " serial" : "",
+             input_sys->espnow_enabled ? " ESP-NOW" : "");
     
     return ESP_OK;
 }
@@ -181,7 +389,11 @@ void input_system_deinit(input_system_t *input_sys) {
     ESP_LOGI(TAG, "Deinitializing input system");
     
     if (input_sys->serial_enabled) {
+        // The task goes first, it blocks on the driver's event queue
+        vTaskDelete(input_sys->serial_task);
         uart_driver_delete(input_sys->config.serial_config.uart_num);
+        input_sys->serial_task = NULL;
+        input_sys->uart_queue = NULL;
     }
     
     input_sys->initialized = false;
@@ -193,22 +405,12 @@ void input_system_process(input_system_t *input_sys) {
         return;
     }
     
-    switch (input_sys->config.enabled_types) {
-        case INPUT_TYPE_SERIAL:
-            if (input_sys->serial_enabled) {
-                input_serial_process(input_sys);
-            }
-            break;
-            
-        case INPUT_TYPE_ESPNOW:
-            if (input_sys->espnow_enabled) {
-                input_espnow_process(input_sys);
-            }
-            break;
-            
-        default:
-            break;
+    // Serial bytes are parsed by the serial task, nothing to read here
+    if (input_sys->espnow_enabled) {
+        input_espnow_process(input_sys);
     }
+    
+    input_dispatch_events(input_sys);
 }
 
 bool input_system_has_pending_input(input_system_t *input_sys) {
@@ -216,15 +418,21 @@ bool input_system_has_pending_input(input_system_t *input_sys) {
         return false;
     }
     
-    if (input_sys->serial_enabled) {
-        size_t available = 0;
-        uart_get_buffered_data_len(input_sys->config.serial_config.uart_num, &available);
-        return available > 0;
+    for (int p = 0; p < INPUT_PRODUCER_COUNT; p++) {
+        if (input_queue_peek(&input_sys->event_queues[p])) {
+            return true;
+        }
     }
     
     return false;
 }
 
+// Lets the consumer task block on a notification instead of polling
+void input_system_set_notify(input_system_t *input_sys, TaskHandle_t task, uint32_t bits) {
+    input_sys->notify_bits = bits;
+    input_sys->notify_task = task;
+}
+
 esp_err_t input_serial_init(input_system_t *input_sys) {
     ESP_LOGI(TAG, "Initializing serial input");
     
@@ -238,7 +446,8 @@ esp_err_t input_serial_init(input_system_t *input_sys) {
     };
     
     esp_err_t ret = uart_driver_install(input_sys->config.serial_config.uart_num, 
-                                        UART_RX_BUF_SIZE, UART_TX_BUF_SIZE, 0, NULL, 0);
+                                        UART_RX_BUF_SIZE, UART_TX_BUF_SIZE,
+                                        INPUT_UART_EVENT_QUEUE_SIZE, &input_sys->uart_queue, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART driver: %s", esp_err_to_name(ret));
         return ret;
@@ -262,6 +471,15 @@ esp_err_t input_serial_init(input_system_t *input_sys) {
         return ret;
     }
     
+    // Next to the WiFi task, input never competes with the render core
+    if (xTaskCreatePinnedToCore(input_serial_task, "input_serial", INPUT_SERIAL_TASK_STACK_SIZE,
+                                input_sys, CONFIG_FLIP_DOT_INPUT_TASK_PRIORITY, &input_sys->serial_task,
+                                CONFIG_FLIP_DOT_INPUT_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create serial input task");
+        uart_driver_delete(input_sys->config.serial_config.uart_num);
+        return ESP_ERR_NO_MEM;
+    }
+    
     ESP_LOGI(TAG, "Serial input initialized on UART%d at %ld baud", 
              input_sys->config.serial_config.uart_num,
              input_sys->config.serial_config.baudrate);
@@ -269,30 +487,16 @@ esp_err_t input_serial_init(input_system_t *input_sys) {
     return ESP_OK;
 }
 
-void input_serial_process(input_system_t *input_sys) {
-    uint8_t data[128];
-    int length = uart_read_bytes(input_sys->config.serial_config.uart_num, 
-                                data, sizeof(data), 0);
+void input_serial_feed(input_system_t *input_sys, const uint8_t *data, size_t len) {
+    input_serial_byte_handler_t handler = g_serial_byte_handler;
     
-    if (length > 0) {
-        for (int i = 0; i < length; i++) {
-            char c = (char)data[i];
-            
-            // Handle escape sequences for arrow keys
-            if (c == '\x1b') {  // ESC character
-                if (i + 2 < length && data[i+1] == '[') {
-                    char arrow_seq[4] = {'\x1b', '[', data[i+2], '\0'};
-                    process_arrow_sequence(input_sys, arrow_seq);
-                    i += 2;  // Skip the next two characters
-                    continue;
-                }
-            }
-            
-            // Handle regular characters
-            if (c >= 32 && c <= 126) {  // Printable ASCII
-                process_serial_char(input_sys, c);
-            }
+    for (size_t i = 0; i < len; i++) {
+        // The hook never sees bytes inside an escape sequence
+        if (handler && input_sys->esc_state == INPUT_ESC_IDLE &&
+            handler(data[i], g_serial_byte_handler_ctx)) {
+            continue;
         }
+        input_serial_parse_byte(input_sys, data[i]);
     }
 }
 
@@ -302,6 +506,13 @@ void input_serial_send_prompt(input_system_t *input_sys, const char* prompt) {
     }
 }
 
+// The context is stored before the handler, so the serial task never sees a
+// handler without its context
+void input_serial_set_byte_handler(input_serial_byte_handler_t handler, void *ctx) {
+    g_serial_byte_handler_ctx = ctx;
+    g_serial_byte_handler = handler;
+}
+
 const char* input_command_to_string(input_command_t command) {
     switch (command) {
         case INPUT_CMD_NONE: return "NONE";
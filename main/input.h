@@ -12,19 +12,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 
 /******************************************************************************
  * Public Definitions and Types
  ******************************************************************************/
 
-// Input types
+// Input types, one bit each so enabled_types can combine them
 typedef enum {
-    INPUT_TYPE_NONE,
-    INPUT_TYPE_SERIAL,
-    INPUT_TYPE_BUTTON,
-    INPUT_TYPE_ENCODER,
-    INPUT_TYPE_TOUCH,
-    INPUT_TYPE_ESPNOW  // Add ESP-NOW input type
+    INPUT_TYPE_NONE    = 0,
+    INPUT_TYPE_SERIAL  = 1 << 0,
+    INPUT_TYPE_BUTTON  = 1 << 1,
+    INPUT_TYPE_ENCODER = 1 << 2,
+    INPUT_TYPE_TOUCH   = 1 << 3,
+    INPUT_TYPE_ESPNOW  = 1 << 4
 } input_type_t;
 
 // Input commands/keys
@@ -53,6 +56,35 @@ typedef struct {
 // Input callback function type
 typedef void (*input_callback_t)(input_event_t *event);
 
+// Event queue, must be a power of two
+#define INPUT_EVENT_QUEUE_SIZE 16
+
+// Lock-free single-producer/single-consumer ring. The receive path pushes,
+// input_system_process() pops and runs the callback in the consumer task.
+typedef struct {
+    input_event_t events[INPUT_EVENT_QUEUE_SIZE];
+    uint32_t head;      // Written by the producer only
+    uint32_t tail;      // Written by the consumer only
+    uint32_t dropped;   // Events lost to a full queue
+    uint32_t rejected;  // Malformed packets the producer threw away
+} input_event_queue_t;
+
+// Receive paths, each pushes into a ring of its own so every ring keeps a
+// single producer
+typedef enum {
+    INPUT_PRODUCER_SERIAL,      // Serial task
+    INPUT_PRODUCER_ESPNOW,      // WiFi task, ESP-NOW receive callback
+    INPUT_PRODUCER_COUNT
+} input_producer_t;
+
+// Escape sequence parser state, kept across UART reads
+typedef enum {
+    INPUT_ESC_IDLE,
+    INPUT_ESC_START,    // ESC seen
+    INPUT_ESC_CSI,      // ESC [ seen, parameters may follow
+    INPUT_ESC_SS3       // ESC O seen, application cursor keys
+} input_esc_state_t;
+
 // Serial input configuration
 typedef struct {
     uint32_t baudrate;
@@ -69,9 +101,17 @@ typedef struct {
     uint8_t peer_mac[6];      // MAC address of the peer device
 } espnow_input_config_t;
 
+// Raw ESP-NOW packet hook, runs in the WiFi task before button decoding.
+// Returns true when it consumed the packet.
+typedef bool (*input_espnow_packet_handler_t)(const uint8_t *src_mac, const uint8_t *data, int len, void *ctx);
+
+// Raw serial byte hook, runs in the serial task before key decoding.
+// Returns true when it consumed the byte.
+typedef bool (*input_serial_byte_handler_t)(uint8_t byte, void *ctx);
+
 // Input system configuration
 typedef struct {
-    input_type_t enabled_types;
+    uint32_t enabled_types;               // INPUT_TYPE_* bits
     serial_input_config_t serial_config;
     espnow_input_config_t espnow_config;  // Add ESP-NOW config
     input_callback_t callback;
@@ -83,8 +123,13 @@ typedef struct {
     bool initialized;
     bool serial_enabled;
     bool espnow_enabled;      // Add ESP-NOW enabled flag
-    uint8_t rx_buffer[256];
-    size_t rx_buffer_pos;
+    input_event_queue_t event_queues[INPUT_PRODUCER_COUNT];
+    QueueHandle_t uart_queue;   // UART driver events
+    TaskHandle_t serial_task;
+    input_esc_state_t esc_state;
+    uint32_t serial_overflows;  // Times the UART lost received bytes
+    TaskHandle_t notify_task;  // Woken when an event is queued, NULL for none
+    uint32_t notify_bits;
 } input_system_t;
 
 /******************************************************************************
@@ -97,6 +142,10 @@ typedef struct {
 #define INPUT_DEFAULT_TX_PIN 1
 #define INPUT_DEFAULT_RX_PIN 3
 
+// Serial task, reads the UART whenever the driver reports data
+#define INPUT_SERIAL_TASK_STACK_SIZE 3072
+#define INPUT_UART_EVENT_QUEUE_SIZE 20
+
 // Key mappings for serial input
 #define INPUT_KEY_UP_CHAR 'w'
 #define INPUT_KEY_DOWN_CHAR 's'
@@ -107,11 +156,12 @@ typedef struct {
 #define INPUT_KEY_RESET_CHAR 'r'   // R for reset
 #define INPUT_KEY_BACK_CHAR 'b'    // B for back
 
-// Alternative arrow key sequences (for terminals that support them)
-#define INPUT_ARROW_UP_SEQ "\x1b[A"
-#define INPUT_ARROW_DOWN_SEQ "\x1b[B"
-#define INPUT_ARROW_RIGHT_SEQ "\x1b[C"
-#define INPUT_ARROW_LEFT_SEQ "\x1b[D"
+// Final byte of the arrow key sequences, ESC [ A or ESC O A in application
+// cursor mode. Modified arrows carry parameters first, e.g. ESC [ 1 ; 5 A.
+#define INPUT_ARROW_UP_FINAL 'A'
+#define INPUT_ARROW_DOWN_FINAL 'B'
+#define INPUT_ARROW_RIGHT_FINAL 'C'
+#define INPUT_ARROW_LEFT_FINAL 'D'
 
 /******************************************************************************
  * Public Function Declarations
@@ -126,19 +176,27 @@ void input_system_deinit(input_system_t *input_sys);
 // Input processing
 void input_system_process(input_system_t *input_sys);
 bool input_system_has_pending_input(input_system_t *input_sys);
+void input_system_set_notify(input_system_t *input_sys, TaskHandle_t task, uint32_t bits);
 
 // Event handling
 void send_input_event(input_system_t *input_sys, input_command_t command, input_type_t type);
 
 // Serial input specific functions
 esp_err_t input_serial_init(input_system_t *input_sys);
-void input_serial_process(input_system_t *input_sys);
+// Parses received bytes into events, called from the serial task. A sequence
+// split across calls is picked up where the last call left it.
+void input_serial_feed(input_system_t *input_sys, const uint8_t *data, size_t len);
+// Queued on the UART TX ring, only waits when the ring is full
 void input_serial_send_prompt(input_system_t *input_sys, const char* prompt);
+void input_serial_set_byte_handler(input_serial_byte_handler_t handler, void *ctx);
 
 // ESP-NOW specific functions
 esp_err_t input_espnow_init(input_system_t *input_sys);
 void input_espnow_process(input_system_t *input_sys);
 espnow_input_config_t input_get_default_espnow_config(void);
+esp_err_t input_espnow_send(const uint8_t *data, size_t len);
+esp_err_t input_espnow_send_to(const uint8_t *mac, const uint8_t *data, size_t len);
+void input_espnow_set_packet_handler(input_espnow_packet_handler_t handler, void *ctx);
 
 // Utility functions
 const char* input_command_to_string(input_command_t command);
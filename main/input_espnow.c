@@ -19,6 +19,10 @@ static const char *TAG = "input_espnow";
 // Global reference to input system
 static input_system_t *g_input_sys = NULL;
 
+// Raw packet hook, e.g. the display server
+static input_espnow_packet_handler_t g_packet_handler = NULL;
+static void *g_packet_handler_ctx = NULL;
+
 // ESP-NOW data structure for controller input
 typedef struct {
     uint8_t buttons;  // Bitmap of button states
@@ -35,10 +39,20 @@ typedef struct {
 #define BTN_RESET_BIT  6
 #define BTN_BACK_BIT   7
 
-// ESP-NOW callback function
+// ESP-NOW callback function, runs in the WiFi task. Events only get queued
+// here, the consumer task acts on them from input_system_process().
 static void espnow_recv_cb(const esp_now_recv_info_t *esp_now_info, const uint8_t *data, int len) {
-    if (!data || len != sizeof(espnow_input_data_t) || !g_input_sys) {
-        ESP_LOGW(TAG, "Invalid data received: len=%d, input_sys=%p", len, g_input_sys);
+    input_espnow_packet_handler_t handler = g_packet_handler;
+    if (handler && data && handler(esp_now_info->src_addr, data, len, g_packet_handler_ctx)) {
+        return;
+    }
+
+    if (!g_input_sys) {
+        return;
+    }
+    // No logging in the WiFi task, the consumer reports the count
+    if (!data || len != sizeof(espnow_input_data_t)) {
+        __atomic_fetch_add(&g_input_sys->event_queues[INPUT_PRODUCER_ESPNOW].rejected, 1, __ATOMIC_RELAXED);
         return;
     }
 
@@ -46,35 +60,27 @@ static void espnow_recv_cb(const esp_now_recv_info_t *esp_now_info, const uint8_
     
     // Process each button state
     if (input_data->buttons & (1 << BTN_UP_BIT)) {
-        ESP_LOGI(TAG, "Button UP pressed");
         send_input_event(g_input_sys, INPUT_CMD_UP, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_DOWN_BIT)) {
-        ESP_LOGI(TAG, "Button DOWN pressed");
         send_input_event(g_input_sys, INPUT_CMD_DOWN, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_LEFT_BIT)) {
-        ESP_LOGI(TAG, "Button LEFT pressed");
         send_input_event(g_input_sys, INPUT_CMD_LEFT, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_RIGHT_BIT)) {
-        ESP_LOGI(TAG, "Button RIGHT pressed");
         send_input_event(g_input_sys, INPUT_CMD_RIGHT, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_SELECT_BIT)) {
-        ESP_LOGI(TAG, "Button SELECT pressed");
         send_input_event(g_input_sys, INPUT_CMD_SELECT, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_START_BIT)) {
-        ESP_LOGI(TAG, "Button START pressed");
         send_input_event(g_input_sys, INPUT_CMD_START, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_RESET_BIT)) {
-        ESP_LOGI(TAG, "Button RESET pressed");
         send_input_event(g_input_sys, INPUT_CMD_RESET, INPUT_TYPE_ESPNOW);
     }
     if (input_data->buttons & (1 << BTN_BACK_BIT)) {
-        ESP_LOGI(TAG, "Button BACK pressed");
         send_input_event(g_input_sys, INPUT_CMD_BACK, INPUT_TYPE_ESPNOW);
     }
 }
@@ -154,6 +160,48 @@ void input_espnow_process(input_system_t *input_sys) {
     // This function is kept for consistency with other input types
 }
 
+// Sends a packet back to the configured controller, e.g. driver stats
+esp_err_t input_espnow_send(const uint8_t *data, size_t len) {
+    if (!g_input_sys || !g_input_sys->espnow_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > ESP_NOW_MAX_DATA_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return esp_now_send(g_input_sys->config.espnow_config.peer_mac, data, len);
+}
+
+// Sends to any station, adding it as an unencrypted peer on first use
+esp_err_t input_espnow_send_to(const uint8_t *mac, const uint8_t *data, size_t len) {
+    if (!g_input_sys || !g_input_sys->espnow_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > ESP_NOW_MAX_DATA_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!esp_now_is_peer_exist(mac)) {
+        esp_now_peer_info_t peer_info = {
+            .channel = g_input_sys->config.espnow_config.channel,
+            .ifidx = ESP_IF_WIFI_STA,
+            .encrypt = false
+        };
+        memcpy(peer_info.peer_addr, mac, ESP_NOW_ETH_ALEN);
+        esp_err_t ret = esp_now_add_peer(&peer_info);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to add peer (error %d)", ret);
+            return ret;
+        }
+    }
+    return esp_now_send(mac, data, len);
+}
+
+// The context is stored before the handler, so the receive callback never
+// sees a handler without its context
+void input_espnow_set_packet_handler(input_espnow_packet_handler_t handler, void *ctx) {
+    g_packet_handler_ctx = ctx;
+    g_packet_handler = handler;
+}
+
 espnow_input_config_t input_get_default_espnow_config(void) {
     espnow_input_config_t config = {
         .channel = 1,
@@ -4,8 +4,12 @@
 #include "pwr_ctrl.h"
 #include "esp_log.h"
 #include "flip_dot.h"
+#include "flip_dot_bench.h"
+#include "flip_anim.h"
+#include "display_server.h"
 #include "snake.h"
 #include "input.h"
+#include "trace.h"
 #include "driver/gpio.h"
 #include "esp_wifi.h"
 #include "esp_mac.h"
@@ -14,6 +18,46 @@ const static char *TAG = "MAIN";
 
 static flip_dot_t flip_dot;
 
+#if CONFIG_FLIP_DOT_SUPPLY_IDLE_OFF_MS > 0
+static flip_dot_supply_gate_t flip_supply_gate;
+#endif
+
+#if CONFIG_FLIP_DOT_ENERGY_MAX_ON_US > 0
+static flip_dot_energy_budget_t flip_energy_budget;
+#endif
+
+#if CONFIG_FLIP_DOT_DISPLAY_SERVER
+static display_server_t display_server;
+static input_system_t input_sys;
+#else
+// Snake keeps its board in a static, the demos build frames on the stack
+#define GAME_TASK_STACK_SIZE 8192
+#define SCENE_TRANSITION_US 1000000
+
+static void clear_scene(flip_dot_transition_t effect);
+static void game_task(void *arg);
+#endif
+
+#if CONFIG_FLIP_DOT_ADAPTIVE_TIMING
+// Coil timing against supply voltage as read by get_battery_voltage(). The
+// middle point is the fixed 2000 us pulse the panel was tuned with, the outer
+// points are estimates, retune them on the bench before relying on them.
+static const flip_dot_timing_point_t flip_timing_curve[] = {
+    { .supply_mv = 1800, .flip_time_us = 2800, .recovery_time_us = 1400 },
+    { .supply_mv = 2200, .flip_time_us = 2000, .recovery_time_us = 1000 },
+    { .supply_mv = 2600, .flip_time_us = 1500, .recovery_time_us = 800 },
+};
+#endif
+
+#if CONFIG_FLIP_DOT_SUPPLY_IDLE_OFF_MS > 0
+// Supply gate switch on, returns once the coils can be pulsed
+static esp_err_t flip_board_power_up(void)
+{
+    enable_flip_board();
+    return wait_flip_board_supply(FLIP_BOARD_MIN_BATTERY_MV);
+}
+#endif
+
 void app_main(void)
 {
     // Print MAC address
@@ -23,28 +67,73 @@ void app_main(void)
              mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 
     init_power_control();
+
+#if CONFIG_FLIP_DOT_TRACE && CONFIG_FLIP_DOT_DISPLAY_SERVER
+    trace_start_dump_task();
+#elif CONFIG_FLIP_DOT_TRACE
+    // Snake's serial input owns the console UART and passes the dump key on
+    input_serial_set_byte_handler(trace_dump_key_handler, NULL);
+#endif
     int voltage_mv;
 
     //Initialize flip dot
     flip_dot_init(&flip_dot, 2000, SWEEP_ROW);
+    flip_dot_set_pipelined(&flip_dot, true);
+#if CONFIG_FLIP_DOT_ADAPTIVE_TIMING
+    flip_dot_enable_adaptive_timing(&flip_dot, get_battery_voltage, flip_timing_curve,
+                                    sizeof(flip_timing_curve) / sizeof(flip_timing_curve[0]), 5000);
+#endif
 
     //Enable flip board
     ESP_LOGI(TAG, "Enabling flip board");
     disable_24V_supply();
     enable_flip_board();
 
-    // Wait a bit for power to stabilize
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    // Wait a bit for power to stabilize, the board rails can't be measured
+    bool board_ready = wait_flip_board_supply(FLIP_BOARD_MIN_BATTERY_MV) == ESP_OK;
+    if (!board_ready) {
+        ESP_LOGW(TAG, "Flip board supply not usable, skipping the boot clear");
+    }
+
+#if CONFIG_FLIP_DOT_SUPPLY_IDLE_OFF_MS > 0
+    // Switch the board off while nothing flips
+    if (flip_dot_supply_gate_init(&flip_supply_gate, flip_board_power_up, disable_flip_board,
+                                  CONFIG_FLIP_DOT_SUPPLY_IDLE_OFF_MS, board_ready) == ESP_OK) {
+        flip_dot_set_supply_gate(&flip_dot, &flip_supply_gate);
+        if (!board_ready) {
+            // The gate tries again before the first pulse
+            disable_flip_board();
+        }
+    }
+#endif
+#if CONFIG_FLIP_DOT_ENERGY_MAX_ON_US > 0
+    flip_dot_energy_budget_init(&flip_energy_budget, CONFIG_FLIP_DOT_ENERGY_MAX_ON_US,
+                                CONFIG_FLIP_DOT_ENERGY_WINDOW_MS * 1000);
+    flip_dot_set_energy_budget(&flip_dot, &flip_energy_budget);
+#endif
+
+    //Clear display, only the dots left set before a reset when that is known
+    if (board_ready) {
+        flip_dot_clear_display_fast(&flip_dot);
+    }
 
-    //Clear display
-    flip_dot_clear_display(&flip_dot);
+    //Hand the panel over to the render task, producers submit frames from here on
+    if (flip_dot_render_start(&flip_dot, FLIP_DOT_RENDER_TASK_CORE, FLIP_DOT_RENDER_TASK_PRIORITY) != ESP_OK) {
+        ESP_LOGW(TAG, "Render task not started, frames will be drawn synchronously");
+    }
 
-    // Initialize input system with ESP-NOW
+#if CONFIG_FLIP_DOT_BENCHMARK
+    // Benchmark build, measure the panel and stop there
+    flip_dot_bench_run(&flip_dot);
+    return;
+#endif
+
+#if CONFIG_FLIP_DOT_DISPLAY_SERVER
+    // Display server build, the remote host draws everything from here on
     input_system_config_t input_config = input_get_default_config();
-    input_config.enabled_types = INPUT_TYPE_ESPNOW;  // Enable ESP-NOW input
+    input_config.enabled_types = INPUT_TYPE_ESPNOW;
     input_config.espnow_config = input_get_default_espnow_config();
     
-    input_system_t input_sys;
     esp_err_t ret = input_system_init(&input_sys, &input_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize input system: %s", esp_err_to_name(ret));
@@ -58,20 +147,70 @@ void app_main(void)
         return;
     }
 
+    ret = display_server_start(&display_server, &flip_dot);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start display server: %s", esp_err_to_name(ret));
+        return;
+    }
+    while (1) {
+        vTaskDelay(10000 / portTICK_PERIOD_MS);
+        display_server_stats_t server_stats;
+        display_server_get_stats(&display_server, &server_stats);
+        ESP_LOGI(TAG, "Display server: %lu keyframes, %lu deltas, %lu late, %lu gaps, %lu requests",
+                 server_stats.keyframes, server_stats.deltas, server_stats.late, server_stats.gaps,
+                 server_stats.keyframe_requests);
+    }
+#else
+    // Games and demos get their own task, app_main is done once it runs
+    if (xTaskCreatePinnedToCore(game_task, "game", GAME_TASK_STACK_SIZE, NULL,
+                                CONFIG_FLIP_DOT_GAME_TASK_PRIORITY, NULL,
+                                CONFIG_FLIP_DOT_GAME_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create game task");
+    }
+#endif
+}
+
+#if !CONFIG_FLIP_DOT_DISPLAY_SERVER
+// Wipes the last scene off before the next demo starts
+static void clear_scene(flip_dot_transition_t effect)
+{
+    flip_dot_frame_t blank;
+    flip_dot_frame_clear(&blank);
+    flip_dot_transition(&flip_dot, &blank, effect, SCENE_TRANSITION_US);
+}
+
+// Producer side of the display: builds frames and submits them to the render
+// task. The snake game brings up ESP-NOW and serial input itself.
+static void game_task(void *arg)
+{
+    // Animation flashed into the anim partition, if any
+    flip_anim_t anim;
+    bool anim_loaded = flip_anim_open_partition(&anim, FLIP_ANIM_PARTITION_LABEL) == ESP_OK;
+
     ESP_LOGI(TAG, "Starting interactive Snake game...");
     snake_game_run_interactive(&flip_dot);
 
     // Demo loop - cycle through different animations
     while (1) {
+        if (anim_loaded) {
+            ESP_LOGI(TAG, "Playing flashed animation...");
+            flip_anim_play(&anim, &flip_dot, 1);
+            
+            vTaskDelay(5000 / portTICK_PERIOD_MS);
+            clear_scene(FLIP_DOT_TRANSITION_DISSOLVE);
+        }
+        
         ESP_LOGI(TAG, "Running bouncing ball demo...");
         flip_dot_demo_bouncing_ball(&flip_dot, 30);
         
         vTaskDelay(5000 / portTICK_PERIOD_MS);
+        clear_scene(FLIP_DOT_TRANSITION_WIPE);
         
         ESP_LOGI(TAG, "Running Snake game demo...");
         snake_game_demo(&flip_dot, 30000);  // Run Snake demo for 30 seconds
         
         vTaskDelay(5000 / portTICK_PERIOD_MS);
+        clear_scene(FLIP_DOT_TRANSITION_SPIRAL);
         
         // ESP_LOGI(TAG, "Running sine wave demo...");
         // flip_dot_demo_sine_wave(&flip_dot, 150);
@@ -93,3 +232,4 @@ void app_main(void)
 
     }
 }
+#endif
@@ -0,0 +1,384 @@
+/**
+ * @file pulse_engine.c
+ * @brief Hardware-timed coil pulse generator implementation
+ *
+ * The enable line is asserted from task context and the GPTimer alarm ISR
+ * releases it after exactly pulse_us, then re-arms itself for the recovery
+ * gap. The caller sleeps on a semaphore meanwhile, so pulse widths are no
+ * longer rounded to FreeRTOS ticks. A second pulse can be queued while the
+ * first one recovers. The ISR then asserts it in the same alarm that ends the
+ * recovery, so there is no task wake-up latency between dots.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "pulse_engine.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+#include "esp_cpu.h"
+#include "flip_dot_hal.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "freertos/task.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "pulse_engine";
+
+// Extra time allowed on top of the pulse before the caller gives up on the ISR
+#define PULSE_ENGINE_TIMEOUT_MARGIN_MS 10
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static bool pulse_engine_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx);
+static void delay_us_blocking(uint32_t us);
+static void pulse_engine_start(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us);
+static void pulse_engine_abort(pulse_engine_t *engine, const char *what);
+static esp_err_t pulse_engine_create_timer(pulse_engine_t *engine);
+static inline void pulse_engine_mark_assert(pulse_engine_t *engine, uint32_t pulse_us);
+static inline void pulse_engine_mark_release(pulse_engine_t *engine);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static bool IRAM_ATTR pulse_engine_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx) {
+    pulse_engine_t *engine = (pulse_engine_t *)user_ctx;
+    BaseType_t high_task_awoken = pdFALSE;
+    gptimer_alarm_config_t alarm_config = {0};
+
+    portENTER_CRITICAL_ISR(&engine->lock);
+    if (engine->phase == PULSE_PHASE_ACTIVE) {
+        // End of the coil pulse, release the enable line first
+        REG_WRITE(engine->release_reg, engine->pin_mask);
+        pulse_engine_mark_release(engine);
+        engine->phase = PULSE_PHASE_RECOVERY;
+        xSemaphoreGiveFromISR(engine->released, &high_task_awoken);
+        if (engine->power_tokens) {
+            xSemaphoreGiveFromISR(engine->power_tokens, &high_task_awoken);
+        }
+
+        if (engine->recovery_us > 0) {
+            alarm_config.alarm_count = edata->alarm_value + engine->recovery_us;
+            gptimer_set_alarm_action(timer, &alarm_config);
+            portEXIT_CRITICAL_ISR(&engine->lock);
+            return high_task_awoken == pdTRUE;
+        }
+    }
+
+    // Recovery gap elapsed, the addresses for a queued pulse are already latched
+    if (engine->queued) {
+        engine->queued = false;
+        engine->recovery_us = engine->next_recovery_us;
+        engine->phase = PULSE_PHASE_ACTIVE;
+        REG_WRITE(engine->assert_reg, engine->pin_mask);
+        pulse_engine_mark_assert(engine, engine->next_pulse_us);
+        alarm_config.alarm_count = edata->alarm_value + engine->next_pulse_us;
+        gptimer_set_alarm_action(timer, &alarm_config);
+        portEXIT_CRITICAL_ISR(&engine->lock);
+        return high_task_awoken == pdTRUE;
+    }
+
+    gptimer_stop(timer);
+    engine->phase = PULSE_PHASE_IDLE;
+    portEXIT_CRITICAL_ISR(&engine->lock);
+    xSemaphoreGiveFromISR(engine->done, &high_task_awoken);
+
+    return high_task_awoken == pdTRUE;
+}
+
+// Stamps a pulse asserted by the ISR. Task context asserts pass 0, the task
+// may run on the other core and its cycle counter is not comparable.
+static inline void IRAM_ATTR pulse_engine_mark_assert(pulse_engine_t *engine, uint32_t pulse_us) {
+#if CONFIG_FLIP_DOT_BENCHMARK
+    engine->assert_cycles = esp_cpu_get_cycle_count();
+    engine->expected_cycles = pulse_us * engine->cycles_per_us;
+#endif
+}
+
+// Books the measured width of an ISR-asserted pulse against the requested one
+static inline void IRAM_ATTR pulse_engine_mark_release(pulse_engine_t *engine) {
+#if CONFIG_FLIP_DOT_BENCHMARK
+    if (engine->expected_cycles == 0) {
+        return;
+    }
+    pulse_engine_accuracy_t *accuracy = &engine->accuracy;
+    int32_t error = (int32_t)(esp_cpu_get_cycle_count() - engine->assert_cycles - engine->expected_cycles);
+    if (accuracy->count == 0 || error < accuracy->min_error_cycles) {
+        accuracy->min_error_cycles = error;
+    }
+    if (accuracy->count == 0 || error > accuracy->max_error_cycles) {
+        accuracy->max_error_cycles = error;
+    }
+    accuracy->sum_error_cycles += error;
+    accuracy->count++;
+    engine->expected_cycles = 0;
+#endif
+}
+
+// Software fallback, sleeps whole ticks and busy-waits the remainder
+static void delay_us_blocking(uint32_t us) {
+    uint32_t ticks = us / (portTICK_PERIOD_MS * 1000);
+    if (ticks > 0) {
+        vTaskDelay(ticks);
+        us -= ticks * portTICK_PERIOD_MS * 1000;
+    }
+    if (us > 0) {
+        flip_dot_hal_delay_us(us);
+    }
+}
+
+// Starts a new pulse chain on an idle timer
+static void pulse_engine_start(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us) {
+    // Drop the completion of the previous chain if nobody waited for it
+    xSemaphoreTake(engine->done, 0);
+
+    engine->recovery_us = recovery_us;
+    engine->phase = PULSE_PHASE_ACTIVE;
+    engine->chain_active = true;
+
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = pulse_us,
+    };
+    gptimer_set_raw_count(engine->timer, 0);
+    gptimer_set_alarm_action(engine->timer, &alarm_config);
+
+    // Assert the enable line right before the timer starts counting
+    REG_WRITE(engine->assert_reg, engine->pin_mask);
+    pulse_engine_mark_assert(engine, 0);
+    gptimer_start(engine->timer);
+}
+
+// Never leave a coil energized if the alarm got lost
+static void pulse_engine_abort(pulse_engine_t *engine, const char *what) {
+    REG_WRITE(engine->release_reg, engine->pin_mask);
+    gptimer_stop(engine->timer);
+    portENTER_CRITICAL(&engine->lock);
+    // A pulse that is on or queued still holds its power token
+    bool token_held = engine->phase == PULSE_PHASE_ACTIVE || engine->queued;
+    engine->queued = false;
+    engine->phase = PULSE_PHASE_IDLE;
+    portEXIT_CRITICAL(&engine->lock);
+    if (token_held && engine->power_tokens) {
+        xSemaphoreGive(engine->power_tokens);
+    }
+    
+    // Drop late gives from the ISR
+    xSemaphoreTake(engine->released, 0);
+    xSemaphoreTake(engine->done, 0);
+    engine->awaiting_release = false;
+    engine->chain_active = false;
+    ESP_LOGE(TAG, "%s timed out, enable line forced off", what);
+}
+
+// The alarm interrupt is allocated on the core that registers the callbacks
+static esp_err_t pulse_engine_create_timer(pulse_engine_t *engine) {
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PULSE_ENGINE_RESOLUTION_HZ,
+    };
+    esp_err_t ret = gptimer_new_timer(&timer_config, &engine->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "No GPTimer available (%s), using software pulse timing", esp_err_to_name(ret));
+        engine->timer = NULL;
+        return ret;
+    }
+
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = pulse_engine_on_alarm,
+    };
+    ret = gptimer_register_event_callbacks(engine->timer, &callbacks, engine);
+    if (ret == ESP_OK) {
+        ret = gptimer_enable(engine->timer);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set up GPTimer (%s), using software pulse timing", esp_err_to_name(ret));
+        gptimer_del_timer(engine->timer);
+        engine->timer = NULL;
+        return ret;
+    }
+    return ESP_OK;
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+esp_err_t pulse_engine_init(pulse_engine_t *engine, uint8_t pin, bool is_inverted) {
+    engine->timer = NULL;
+    engine->pin = pin;
+    engine->pin_mask = 1UL << (pin & 31);
+    engine->recovery_us = 0;
+    engine->phase = PULSE_PHASE_IDLE;
+    engine->queued = false;
+    engine->awaiting_release = false;
+    engine->chain_active = false;
+    engine->timeout = 0;
+    engine->power_tokens = NULL;
+    portMUX_INITIALIZE(&engine->lock);
+#if CONFIG_FLIP_DOT_BENCHMARK
+    engine->cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+    engine->expected_cycles = 0;
+    engine->accuracy = (pulse_engine_accuracy_t){0};
+#endif
+
+    uint32_t set_reg = (pin < 32) ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG;
+    uint32_t clr_reg = (pin < 32) ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG;
+    engine->assert_reg = is_inverted ? clr_reg : set_reg;
+    engine->release_reg = is_inverted ? set_reg : clr_reg;
+
+    engine->done = xSemaphoreCreateBinary();
+    if (!engine->done) {
+        ESP_LOGE(TAG, "Failed to create pulse semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+    engine->released = xSemaphoreCreateBinary();
+    if (!engine->released) {
+        ESP_LOGE(TAG, "Failed to create release semaphore");
+        vSemaphoreDelete(engine->done);
+        engine->done = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = pulse_engine_create_timer(engine);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Pulse engine ready on GPIO%d (core %d)", pin, xPortGetCoreID());
+    return ESP_OK;
+}
+
+esp_err_t pulse_engine_bind_to_current_core(pulse_engine_t *engine) {
+    if (!engine->timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Only the timer is rebuilt, the semaphores and power tokens stay
+    pulse_engine_wait_idle(engine);
+    gptimer_disable(engine->timer);
+    gptimer_del_timer(engine->timer);
+    engine->timer = NULL;
+    esp_err_t ret = pulse_engine_create_timer(engine);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Pulse engine on GPIO%d moved to core %d", engine->pin, xPortGetCoreID());
+    return ESP_OK;
+}
+
+void pulse_engine_deinit(pulse_engine_t *engine) {
+    if (engine->timer) {
+        gptimer_disable(engine->timer);
+        gptimer_del_timer(engine->timer);
+        engine->timer = NULL;
+    }
+    if (engine->done) {
+        vSemaphoreDelete(engine->done);
+        engine->done = NULL;
+    }
+    if (engine->released) {
+        vSemaphoreDelete(engine->released);
+        engine->released = NULL;
+    }
+}
+
+void pulse_engine_fire(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us) {
+    pulse_engine_queue(engine, pulse_us, recovery_us);
+    pulse_engine_wait_idle(engine);
+}
+
+void pulse_engine_wait_released(pulse_engine_t *engine) {
+    if (!engine->awaiting_release) {
+        return;
+    }
+    if (xSemaphoreTake(engine->released, engine->timeout) != pdTRUE) {
+        pulse_engine_abort(engine, "Pulse release");
+        return;
+    }
+    engine->awaiting_release = false;
+}
+
+void pulse_engine_queue(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us) {
+    if (pulse_us == 0) {
+        return;
+    }
+
+    if (!engine->timer) {
+        if (engine->power_tokens) {
+            xSemaphoreTake(engine->power_tokens, portMAX_DELAY);
+        }
+        REG_WRITE(engine->assert_reg, engine->pin_mask);
+        delay_us_blocking(pulse_us);
+        REG_WRITE(engine->release_reg, engine->pin_mask);
+        if (engine->power_tokens) {
+            xSemaphoreGive(engine->power_tokens);
+        }
+        delay_us_blocking(recovery_us);
+        return;
+    }
+
+    // The previous pulse must be off the coil before it can be chained
+    pulse_engine_wait_released(engine);
+
+    // Wait for room in the power budget. Should the recovery end meanwhile,
+    // the chain goes idle and this pulse starts a new one below.
+    if (engine->power_tokens) {
+        xSemaphoreTake(engine->power_tokens, portMAX_DELAY);
+    }
+
+    // Covers the recovery still running ahead of this pulse
+    engine->timeout = pdMS_TO_TICKS((engine->recovery_us + pulse_us + recovery_us) / 1000 + PULSE_ENGINE_TIMEOUT_MARGIN_MS);
+    engine->awaiting_release = true;
+
+    portENTER_CRITICAL(&engine->lock);
+    if (engine->phase == PULSE_PHASE_RECOVERY) {
+        engine->next_pulse_us = pulse_us;
+        engine->next_recovery_us = recovery_us;
+        engine->queued = true;
+        portEXIT_CRITICAL(&engine->lock);
+        return;
+    }
+    portEXIT_CRITICAL(&engine->lock);
+
+    pulse_engine_start(engine, pulse_us, recovery_us);
+}
+
+void pulse_engine_wait_idle(pulse_engine_t *engine) {
+    if (!engine->chain_active) {
+        return;
+    }
+    pulse_engine_wait_released(engine);
+    if (engine->chain_active && xSemaphoreTake(engine->done, engine->timeout) != pdTRUE) {
+        pulse_engine_abort(engine, "Pulse recovery");
+        return;
+    }
+    engine->chain_active = false;
+}
+
+void pulse_engine_set_power_tokens(pulse_engine_t *engine, SemaphoreHandle_t tokens) {
+    engine->power_tokens = tokens;
+}
+
+#if CONFIG_FLIP_DOT_BENCHMARK
+void pulse_engine_get_accuracy(pulse_engine_t *engine, pulse_engine_accuracy_t *accuracy) {
+    portENTER_CRITICAL(&engine->lock);
+    *accuracy = engine->accuracy;
+    portEXIT_CRITICAL(&engine->lock);
+}
+
+void pulse_engine_reset_accuracy(pulse_engine_t *engine) {
+    portENTER_CRITICAL(&engine->lock);
+    engine->accuracy = (pulse_engine_accuracy_t){0};
+    engine->expected_cycles = 0;
+    portEXIT_CRITICAL(&engine->lock);
+}
+#endif
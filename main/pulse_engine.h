@@ -0,0 +1,110 @@
+/**
+ * @file pulse_engine.h
+ * @brief Hardware-timed coil pulse generator for the flip dot enable line
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef PULSE_ENGINE_H
+#define PULSE_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+// Pulse phases, advanced by the timer alarm ISR
+typedef enum {
+    PULSE_PHASE_IDLE,
+    PULSE_PHASE_ACTIVE,     // Enable line asserted, coil is being driven
+    PULSE_PHASE_RECOVERY    // Enable line released, capacitor recovering
+} pulse_phase_t;
+
+// Enable line width measured by the ISR against the requested width
+typedef struct {
+    uint32_t count;              // Pulses measured, only those the ISR both asserted and released
+    int32_t min_error_cycles;
+    int32_t max_error_cycles;
+    int64_t sum_error_cycles;
+} pulse_engine_accuracy_t;
+
+// Pulse engine state
+typedef struct {
+    gptimer_handle_t timer;        // NULL when running in software fallback mode
+    SemaphoreHandle_t done;        // Given by the ISR when the recovery gap has elapsed
+    uint8_t pin;
+    uint32_t pin_mask;             // Bit of the enable pin in its GPIO output bank
+    uint32_t assert_reg;           // W1TS/W1TC register that drives the pin active
+    uint32_t release_reg;          // W1TS/W1TC register that drives the pin inactive
+    volatile uint32_t recovery_us; // Recovery gap following the current pulse
+    volatile pulse_phase_t phase;
+
+    // Pipelining, one pulse can be queued to start when the current recovery ends
+    portMUX_TYPE lock;             // Guards the queued pulse against the ISR
+    SemaphoreHandle_t released;    // Given by the ISR each time the enable line is released
+    volatile bool queued;
+    volatile uint32_t next_pulse_us;
+    volatile uint32_t next_recovery_us;
+    bool awaiting_release;         // A started pulse has not been seen released yet
+    bool chain_active;             // Pulses started since the last wait for idle
+    TickType_t timeout;            // Safety timeout for the pulse in flight
+    SemaphoreHandle_t power_tokens; // Shared between panels, one per coil pulse on at once, NULL for no limit
+
+#if CONFIG_FLIP_DOT_BENCHMARK
+    uint32_t cycles_per_us;
+    uint32_t assert_cycles;        // CPU cycle count when the ISR asserted the current pulse
+    uint32_t expected_cycles;      // Requested width of that pulse, 0 when asserted from a task
+    pulse_engine_accuracy_t accuracy;
+#endif
+} pulse_engine_t;
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+// Timer resolution, one tick per microsecond
+#define PULSE_ENGINE_RESOLUTION_HZ 1000000
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+esp_err_t pulse_engine_init(pulse_engine_t *engine, uint8_t pin, bool is_inverted);
+void pulse_engine_deinit(pulse_engine_t *engine);
+
+// Moves the alarm interrupt to the calling core, away from the WiFi core.
+// Falls back to software timing if the timer cannot be recreated.
+esp_err_t pulse_engine_bind_to_current_core(pulse_engine_t *engine);
+
+// Drive the enable line for exactly pulse_us, then hold it released for
+// recovery_us. Blocks the caller (without spinning) until both have elapsed.
+void pulse_engine_fire(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us);
+
+// Pipelined use: wait until the enable line is released, change the addresses,
+// then queue the next pulse. A queued pulse starts from the ISR the moment the
+// current recovery gap ends. Call pulse_engine_wait_idle() before anything else
+// touches the panel lines.
+void pulse_engine_wait_released(pulse_engine_t *engine);
+void pulse_engine_queue(pulse_engine_t *engine, uint32_t pulse_us, uint32_t recovery_us);
+void pulse_engine_wait_idle(pulse_engine_t *engine);
+
+// Power budget across engines on one supply. Every pulse takes a token from
+// the counting semaphore before it is started or queued, and the ISR gives it
+// back when the enable line drops. Set while the engine is idle.
+void pulse_engine_set_power_tokens(pulse_engine_t *engine, SemaphoreHandle_t tokens);
+
+#if CONFIG_FLIP_DOT_BENCHMARK
+// Pulse width accuracy since the last reset, see flip_dot_bench.c
+void pulse_engine_get_accuracy(pulse_engine_t *engine, pulse_engine_accuracy_t *accuracy);
+void pulse_engine_reset_accuracy(pulse_engine_t *engine);
+#endif
+
+#endif /* PULSE_ENGINE_H */
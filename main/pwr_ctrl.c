@@ -23,6 +23,13 @@
 #define BATTERY_VOLTAGE_ADC_CH ADC_CHANNEL_7
 #define ADC_ATTEN ADC_ATTEN_DB_12
 
+// Neither flip board rail has an ADC channel, so both waits are fixed. These
+// are the settle times the panel was brought up and has always run with,
+// keep them until the rails are measured. The battery reading only tells
+// whether the source can feed the board at all.
+#define FLIP_BOARD_LOGIC_SETTLE_MS 250
+#define FLIP_BOARD_SUPPLY_SETTLE_MS 1000
+
 const static char *TAG = "PWR_CTRL";
 adc_oneshot_unit_handle_t adc1_handle;
 adc_cali_handle_t adc1_cali_handle = NULL;
@@ -182,7 +189,7 @@ esp_err_t enable_flip_board(void)
     //Enable flip board logic supply
     enable_flip_board_logic_supply();
 
-    vTaskDelay(250 / portTICK_PERIOD_MS);
+    vTaskDelay(pdMS_TO_TICKS(FLIP_BOARD_LOGIC_SETTLE_MS));
     return ESP_OK;
 }
 
@@ -203,13 +210,37 @@ esp_err_t get_battery_voltage(int* voltage_mv)
 
     // Get battery voltage
     //Read ADC channel 0
-    ESP_ERROR_CHECK(adc_oneshot_read(adc1_handle, BATTERY_VOLTAGE_ADC_CH, &adc_raw));
+    // Read from the render task and every supply power-up, a failed read
+    // leaves the caller on fixed timing instead of aborting
+    esp_err_t ret = adc_oneshot_read(adc1_handle, BATTERY_VOLTAGE_ADC_CH, &adc_raw);
+    if (ret != ESP_OK) {
+        return ret;
+    }
     ESP_LOGD(TAG, "ADC%d Channel[%d] Raw Data: %d", ADC_UNIT_1 + 1, BATTERY_VOLTAGE_ADC_CH, adc_raw);
-    if (do_calibration1_chan0) {
-        ESP_ERROR_CHECK(adc_cali_raw_to_voltage(adc1_cali_handle, adc_raw, &voltage));
-        ESP_LOGD(TAG, "ADC%d Channel[%d] Cali Voltage: %d mV", ADC_UNIT_1 + 1, BATTERY_VOLTAGE_ADC_CH, voltage);
+    if (!do_calibration1_chan0) {
+        // Raw counts are not millivolts, don't hand out a made up value
+        return ESP_ERR_NOT_SUPPORTED;
     }
+    ret = adc_cali_raw_to_voltage(adc1_cali_handle, adc_raw, &voltage);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_LOGD(TAG, "ADC%d Channel[%d] Cali Voltage: %d mV", ADC_UNIT_1 + 1, BATTERY_VOLTAGE_ADC_CH, voltage);
     *voltage_mv = voltage;
     return ESP_OK;
 }
 
+// Waits out the coil supply settle time after enable_flip_board(). Fails
+// right away when the battery is below min_battery_mv, the board would not
+// come up on it.
+esp_err_t wait_flip_board_supply(int min_battery_mv)
+{
+    int voltage_mv;
+    if (get_battery_voltage(&voltage_mv) == ESP_OK && voltage_mv < min_battery_mv) {
+        ESP_LOGW(TAG, "Battery at %d mV, below %d mV, flip board supply not usable", voltage_mv, min_battery_mv);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(FLIP_BOARD_SUPPLY_SETTLE_MS));
+    return ESP_OK;
+}
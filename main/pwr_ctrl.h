@@ -22,6 +22,9 @@
  * Public Constants
  ******************************************************************************/
 
+// Lowest battery reading, from get_battery_voltage(), the flip board is
+// powered up on
+#define FLIP_BOARD_MIN_BATTERY_MV 1800
 
 /******************************************************************************
  * Public Function Declarations
@@ -33,6 +36,7 @@ esp_err_t disable_flip_board_logic_supply(void);
 esp_err_t enable_flip_board(void);
 esp_err_t disable_flip_board(void);
 esp_err_t get_battery_voltage(int* voltage_mv);
+esp_err_t wait_flip_board_supply(int min_battery_mv);
 esp_err_t init_power_control(void);
 
 #endif /* PWR_CTRL_H */
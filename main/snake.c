@@ -8,9 +8,11 @@
 
 #include "snake.h"
 #include "input.h"
+#include "trace.h"
 #include <string.h>
 #include <stdlib.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -20,6 +22,22 @@
 
 static const char *TAG = "snake_game";
 
+// Task notification bits of the game loop
+#define SNAKE_NOTIFY_TICK  (1 << 0)
+#define SNAKE_NOTIFY_INPUT (1 << 1)
+
+// A tick that is this late is taken as lost and run from the wait timeout
+#define SNAKE_CLOCK_SLACK_MS 20
+
+// Game clock, a periodic esp_timer that notifies the game task
+typedef struct {
+    esp_timer_handle_t timer;
+    TaskHandle_t task;
+    uint32_t period_ms;
+    bool running;
+    int64_t next_tick_us;   // Only touched by the game task
+} snake_clock_t;
+
 /******************************************************************************
  * Private Function Declarations
  ******************************************************************************/
@@ -29,8 +47,18 @@ static void init_snake(snake_t *snake);
 static void move_snake(snake_t *snake);
 static bool is_valid_position(position_t pos);
 static bool is_position_in_snake(snake_t *snake, position_t pos);
+static position_t snake_segment(const snake_t *snake, uint16_t i);
+static void free_set_init(snake_game_t *game);
+static void emit_change(snake_game_t *game, position_t pos, bool value);
+static void free_set_take(snake_free_set_t *set, position_t pos);
+static void free_set_release(snake_free_set_t *set, position_t pos);
 static void clear_game_buffer(uint8_t buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH]);
 static uint32_t get_random_number(uint32_t max);
+static void snake_clock_cb(void *arg);
+static esp_err_t snake_clock_init(snake_clock_t *game_clock);
+static void snake_clock_deinit(snake_clock_t *game_clock);
+static void snake_clock_sync(snake_clock_t *game_clock, bool run, uint32_t period_ms);
+static uint32_t snake_clock_wait(snake_clock_t *game_clock, TickType_t idle_timeout);
 
 /******************************************************************************
  * Private Function Implementations
@@ -38,7 +66,10 @@ static uint32_t get_random_number(uint32_t max);
 
 static void init_snake(snake_t *snake) {
     snake->length = SNAKE_INITIAL_LENGTH;
+    snake->head = SNAKE_INITIAL_LENGTH - 1;
     snake->direction = DIR_RIGHT;
+    snake->self_hit = false;
+    flip_dot_frame_clear(&snake->occupied);
     
     // Initialize input buffer
     direction_buffer_init(&snake->input_buffer);
@@ -47,10 +78,18 @@ static void init_snake(snake_t *snake) {
     uint8_t start_x = (GAME_MIN_X + GAME_MAX_X) / 2;
     uint8_t start_y = (GAME_MIN_Y + GAME_MAX_Y) / 2;
     
-    for (uint8_t i = 0; i < snake->length; i++) {
-        snake->segments[i].x = start_x - i;
-        snake->segments[i].y = start_y;
+    for (uint16_t i = 0; i < snake->length; i++) {
+        position_t pos = {start_x - i, start_y};
+        snake->segments[snake->head - i] = pos;
+        flip_dot_frame_set(&snake->occupied, pos.y, pos.x, true);
     }
+    snake->last_tail = snake_segment(snake, snake->length - 1);
+}
+
+// Segment i counted from the head
+static position_t snake_segment(const snake_t *snake, uint16_t i) {
+    uint16_t index = snake->head >= i ? snake->head - i : snake->head + SNAKE_MAX_LENGTH - i;
+    return snake->segments[index];
 }
 
 static void move_snake(snake_t *snake) {
@@ -69,12 +108,12 @@ static void move_snake(snake_t *snake) {
         if (valid_change) {
             snake->direction = next_direction;
         } else {
-            ESP_LOGD(TAG, "Invalid direction change blocked: %d -> %d", snake->direction, next_direction);
+            TRACE(SNAKE_DIR_BLOCKED, snake->direction, next_direction);
         }
     }
     
     // Calculate new head position
-    position_t new_head = snake->segments[0];
+    position_t new_head = snake->segments[snake->head];
     
     switch (snake->direction) {
         case DIR_UP:
@@ -91,18 +130,19 @@ static void move_snake(snake_t *snake) {
             break;
     }
     
-    // Debug: check if new head would be at (0,0)
-    if (new_head.x == 0 && new_head.y == 0) {
-        ESP_LOGW(TAG, "WARNING: New snake head would be at (0,0)!");
-    }
+    // Drop the tail first, the head may move into the cell it leaves
+    snake->last_tail = snake_segment(snake, snake->length - 1);
+    flip_dot_frame_set(&snake->occupied, snake->last_tail.y, snake->last_tail.x, false);
     
-    // Move body segments
-    for (int8_t i = snake->length - 1; i > 0; i--) {
-        snake->segments[i] = snake->segments[i - 1];
-    }
+    // Advance the head, a full ring reuses the slot the tail just left
+    snake->head = (snake->head + 1) % SNAKE_MAX_LENGTH;
+    snake->segments[snake->head] = new_head;
     
-    // Set new head position
-    snake->segments[0] = new_head;
+    snake->self_hit = false;
+    if (is_valid_position(new_head)) {
+        snake->self_hit = flip_dot_frame_get(&snake->occupied, new_head.y, new_head.x);
+        flip_dot_frame_set(&snake->occupied, new_head.y, new_head.x, true);
+    }
 }
 
 static bool is_valid_position(position_t pos) {
@@ -110,12 +150,61 @@ static bool is_valid_position(position_t pos) {
 }
 
 static bool is_position_in_snake(snake_t *snake, position_t pos) {
-    for (uint8_t i = 0; i < snake->length; i++) {
-        if (snake->segments[i].x == pos.x && snake->segments[i].y == pos.y) {
-            return true;
+    return is_valid_position(pos) && flip_dot_frame_get(&snake->occupied, pos.y, pos.x);
+}
+
+// Every cell that holds neither snake nor food
+static void free_set_init(snake_game_t *game) {
+    snake_free_set_t *set = &game->free_set;
+    set->free_count = 0;
+    for (uint8_t y = GAME_MIN_Y; y <= GAME_MAX_Y; y++) {
+        for (uint8_t x = GAME_MIN_X; x <= GAME_MAX_X; x++) {
+            uint16_t cell = y * DISPLAY_WIDTH + x;
+            set->free_slot[cell] = SNAKE_CELL_NONE;
+            
+            // Food never goes on (0,0), it stays out of the set
+            position_t pos = {x, y};
+            if ((x == 0 && y == 0) || is_position_in_snake(&game->snake, pos)) {
+                continue;
+            }
+            set->free_slot[cell] = set->free_count;
+            set->free_cells[set->free_count++] = cell;
         }
     }
-    return false;
+    for (uint8_t i = 0; i < FOOD_COUNT; i++) {
+        if (game->food[i].active) {
+            free_set_take(set, game->food[i].position);
+        }
+    }
+}
+
+// Removes a cell, the last entry moves into its slot
+static void free_set_take(snake_free_set_t *set, position_t pos) {
+    uint16_t cell = pos.y * DISPLAY_WIDTH + pos.x;
+    uint16_t slot = set->free_slot[cell];
+    if (slot == SNAKE_CELL_NONE) {
+        return;
+    }
+    uint16_t last = set->free_cells[--set->free_count];
+    set->free_cells[slot] = last;
+    set->free_slot[last] = slot;
+    set->free_slot[cell] = SNAKE_CELL_NONE;
+}
+
+static void free_set_release(snake_free_set_t *set, position_t pos) {
+    uint16_t cell = pos.y * DISPLAY_WIDTH + pos.x;
+    if (cell == 0 || set->free_slot[cell] != SNAKE_CELL_NONE) {
+        return;
+    }
+    set->free_slot[cell] = set->free_count;
+    set->free_cells[set->free_count++] = cell;
+}
+
+// Queues a dot change for the end of the tick
+static void emit_change(snake_game_t *game, position_t pos, bool value) {
+    if (game->change_count < SNAKE_MAX_TICK_CHANGES) {
+        game->changes[game->change_count++] = (flip_dot_change_t){ .row = pos.y, .col = pos.x, .value = value };
+    }
 }
 
 static void clear_game_buffer(uint8_t buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH]) {
@@ -126,6 +215,88 @@ static uint32_t get_random_number(uint32_t max) {
     return rand() % max;
 }
 
+static void snake_clock_cb(void *arg) {
+    snake_clock_t *game_clock = (snake_clock_t *)arg;
+    xTaskNotify(game_clock->task, SNAKE_NOTIFY_TICK, eSetBits);
+}
+
+static esp_err_t snake_clock_init(snake_clock_t *game_clock) {
+    game_clock->task = xTaskGetCurrentTaskHandle();
+    game_clock->period_ms = 0;
+    game_clock->running = false;
+    game_clock->next_tick_us = 0;
+    
+    esp_timer_create_args_t timer_args = {
+        .callback = snake_clock_cb,
+        .arg = game_clock,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "snake_tick",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &game_clock->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create game clock: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static void snake_clock_deinit(snake_clock_t *game_clock) {
+    if (game_clock->running) {
+        esp_timer_stop(game_clock->timer);
+    }
+    esp_timer_delete(game_clock->timer);
+}
+
+// Starts, stops or re-times the clock to match the game
+static void snake_clock_sync(snake_clock_t *game_clock, bool run, uint32_t period_ms) {
+    if (!run) {
+        if (game_clock->running) {
+            esp_timer_stop(game_clock->timer);
+            game_clock->running = false;
+        }
+        return;
+    }
+    if (game_clock->running && game_clock->period_ms == period_ms) {
+        return;
+    }
+    
+    // Level up, or the game just started, the next tick is one period from now
+    if (game_clock->running) {
+        esp_timer_restart(game_clock->timer, period_ms * 1000ULL);
+    } else {
+        esp_timer_start_periodic(game_clock->timer, period_ms * 1000ULL);
+    }
+    game_clock->running = true;
+    game_clock->period_ms = period_ms;
+    game_clock->next_tick_us = esp_timer_get_time() + period_ms * 1000LL;
+}
+
+// Blocks until the next tick or input, returns the notification bits. While
+// the clock runs the wait is bounded by the next tick, so a lost timer
+// notification still advances the game.
+static uint32_t snake_clock_wait(snake_clock_t *game_clock, TickType_t idle_timeout) {
+    TickType_t timeout = idle_timeout;
+    if (game_clock->running) {
+        int64_t wait_ms = (game_clock->next_tick_us - esp_timer_get_time()) / 1000 + SNAKE_CLOCK_SLACK_MS;
+        TickType_t tick_timeout = wait_ms > 0 ? pdMS_TO_TICKS(wait_ms) : 0;
+        if (tick_timeout < timeout) {
+            timeout = tick_timeout;
+        }
+    }
+    
+    uint32_t events = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &events, timeout) != pdTRUE) {
+        events = 0;
+        if (game_clock->running && esp_timer_get_time() >= game_clock->next_tick_us) {
+            events = SNAKE_NOTIFY_TICK;
+        }
+    }
+    
+    if (events & SNAKE_NOTIFY_TICK) {
+        game_clock->next_tick_us += game_clock->period_ms * 1000LL;
+    }
+    return events;
+}
+
 /******************************************************************************
  * Input Buffer Functions
  ******************************************************************************/
@@ -146,7 +317,7 @@ bool direction_buffer_push(direction_buffer_t *buffer, snake_direction_t directi
     buffer->head = (buffer->head + 1) % DIRECTION_BUFFER_SIZE;
     buffer->count++;
     
-    ESP_LOGD(TAG, "Direction %d buffered (count: %d)", direction, buffer->count);
+    TRACE(SNAKE_DIR_PUSH, direction, buffer->count);
     return true;
 }
 
@@ -159,7 +330,7 @@ bool direction_buffer_pop(direction_buffer_t *buffer, snake_direction_t *directi
     buffer->tail = (buffer->tail + 1) % DIRECTION_BUFFER_SIZE;
     buffer->count--;
     
-    ESP_LOGD(TAG, "Direction %d popped from buffer (count: %d)", *direction, buffer->count);
+    TRACE(SNAKE_DIR_POP, *direction, buffer->count);
     return true;
 }
 
@@ -176,6 +347,7 @@ void snake_game_init(snake_game_t *game, flip_dot_t *display) {
     
     game->display = display;
     game->state = GAME_INIT;
+    game->change_count = 0;
     game->score = 0;
     game->level = 1;
     game->game_speed_ms = SNAKE_INITIAL_SPEED_MS;
@@ -194,7 +366,10 @@ void snake_game_init(snake_game_t *game, flip_dot_t *display) {
     }
     
     // Generate initial food
-    snake_game_generate_food(game);
+    free_set_init(game);
+    for (uint8_t i = 0; i < FOOD_COUNT; i++) {
+        snake_game_generate_food(game);
+    }
     
     ESP_LOGI(TAG, "Snake game initialized");
 }
@@ -216,7 +391,10 @@ void snake_game_reset(snake_game_t *game) {
         game->food[i].position.x = 255;  // Invalid position
         game->food[i].position.y = 255;  // Invalid position
     }
-    snake_game_generate_food(game);
+    free_set_init(game);
+    for (uint8_t i = 0; i < FOOD_COUNT; i++) {
+        snake_game_generate_food(game);
+    }
     
     // Clear display
     clear_game_buffer(game->game_buffer);
@@ -252,11 +430,10 @@ void snake_game_update(snake_game_t *game) {
         return;
     }
     
-    // Store the tail position BEFORE moving, in case we need to grow
-    position_t tail_pos_before_move = game->snake.segments[game->snake.length - 1];
-    
     // Move snake
     move_snake(&game->snake);
+    TRACE(SNAKE_TICK, TRACE_PACK(game->snake.segments[game->snake.head].x, game->snake.segments[game->snake.head].y),
+          game->snake.length);
     
     // Check for collisions
     if (snake_game_check_collision(game)) {
@@ -265,22 +442,31 @@ void snake_game_update(snake_game_t *game) {
         return;
     }
     
+    // The head may have moved into the vacated tail cell, release before take
+    free_set_release(&game->free_set, game->snake.last_tail);
+    free_set_take(&game->free_set, game->snake.segments[game->snake.head]);
+    
+    // Same order for the display, a later change to the same dot wins
+    game->change_count = 0;
+    emit_change(game, game->snake.last_tail, false);
+    emit_change(game, game->snake.segments[game->snake.head], true);
+    
     // Check for food collision
     if (snake_game_check_food_collision(game)) {
         ESP_LOGI(TAG, "Food eaten! Score: %ld", game->score);
         
         // Increase snake length and properly initialize new tail
         if (game->snake.length < SNAKE_MAX_LENGTH) {
-            uint8_t old_length = game->snake.length;
+            position_t tail_pos_before_move = game->snake.last_tail;
             
+            // The ring slot behind the tail still holds the tail from BEFORE
+            // the move, growing into it ensures immediate visual growth
             game->snake.length++;
+            flip_dot_frame_set(&game->snake.occupied, tail_pos_before_move.y, tail_pos_before_move.x, true);
+            free_set_take(&game->free_set, tail_pos_before_move);
+            emit_change(game, tail_pos_before_move, true);
             
-            // Set the new tail segment to where the tail was BEFORE the move
-            // This ensures immediate visual growth
-            game->snake.segments[game->snake.length - 1] = tail_pos_before_move;
-            
-            ESP_LOGI(TAG, "Snake length increased from %d to %d", old_length, game->snake.length);
-            ESP_LOGI(TAG, "New tail segment at (%d, %d) (tail pos before move)", tail_pos_before_move.x, tail_pos_before_move.y);
+            TRACE(SNAKE_GROW, game->snake.length, TRACE_PACK(tail_pos_before_move.x, tail_pos_before_move.y));
         }
         
         // Increase score
@@ -298,14 +484,11 @@ void snake_game_update(snake_game_t *game) {
             ESP_LOGI(TAG, "Level up! Level: %ld, Speed: %ld ms", game->level, game->game_speed_ms);
         }
         
-        // Generate new food - with debug logging
-        ESP_LOGI(TAG, "Generating new food after eating...");
         snake_game_generate_food(game);
-        ESP_LOGI(TAG, "New food generation completed");
     }
     
-    // Render the game
-    snake_game_render(game);
+    // Only flip the dots this tick changed
+    flip_dot_apply_changes(game->display, game->changes, game->change_count);
 }
 
 void snake_game_change_direction(snake_game_t *game, snake_direction_t new_direction) {
@@ -327,29 +510,17 @@ void snake_game_render(snake_game_t *game) {
     // Clear the game buffer
     clear_game_buffer(game->game_buffer);
     
-    // Debug: check if (0,0) gets set during snake drawing
-    bool pixel_0_0_set_by_snake = false;
-    
-    // Draw snake
-    for (uint8_t i = 0; i < game->snake.length; i++) {
-        position_t pos = game->snake.segments[i];
-        if (pos.x < DISPLAY_WIDTH && pos.y < DISPLAY_HEIGHT) {
-            if (pos.x == 0 && pos.y == 0) {
-                ESP_LOGW(TAG, "WARNING: Snake segment %d is at (0,0)!", i);
-                pixel_0_0_set_by_snake = true;
-            }
-            game->game_buffer[pos.y][pos.x] = 1;
-        }
-    }
+    // Draw snake straight from the occupancy bitmap
+    flip_dot_frame_unpack(&game->snake.occupied, game->game_buffer);
     
     // Draw food
     for (uint8_t i = 0; i < FOOD_COUNT; i++) {
         if (game->food[i].active) {
             position_t pos = game->food[i].position;
             
-            // Debug: log if we're about to draw at (0,0)
+            // Food at (0,0) is never drawn
             if (pos.x == 0 && pos.y == 0) {
-                ESP_LOGW(TAG, "WARNING: About to draw food at (0,0)! Deactivating food.");
+                TRACE(SNAKE_FOOD_DROPPED, TRACE_PACK(pos.x, pos.y), 0);
                 game->food[i].active = false;
                 continue;
             }
@@ -365,14 +536,10 @@ void snake_game_render(snake_game_t *game) {
         }
     }
     
-    // Debug: check if (0,0) is set in the final buffer
-    if (game->game_buffer[0][0] == 1) {
-        ESP_LOGW(TAG, "WARNING: Pixel (0,0) is SET in game buffer! Snake: %s", 
-                 pixel_0_0_set_by_snake ? "YES" : "NO");
-    }
+    TRACE(SNAKE_RENDER, game->snake.length, 0);
     
     // Update the display
-    flip_dot_update_display(game->display, game->game_buffer);
+    flip_dot_submit_frame(game->display, game->game_buffer);
 }
 
 void snake_game_show_game_over(snake_game_t *game) {
@@ -389,8 +556,10 @@ void snake_game_show_game_over(snake_game_t *game) {
         game->game_buffer[i][DISPLAY_WIDTH / 2] = 1;   // Vertical line
     }
     
-    // Update display
-    flip_dot_update_display(game->display, game->game_buffer);
+    // Dissolve into it at an even pace instead of a burst of flips
+    flip_dot_frame_t frame;
+    flip_dot_frame_pack(&frame, game->game_buffer);
+    flip_dot_transition(game->display, &frame, FLIP_DOT_TRANSITION_DISSOLVE, SNAKE_GAME_OVER_TRANSITION_US);
     
     // Hold for a few seconds
     vTaskDelay(3000 / portTICK_PERIOD_MS);
@@ -404,95 +573,55 @@ void snake_game_show_score(snake_game_t *game) {
 
 void snake_game_generate_food(snake_game_t *game) {
     // Find inactive food slot
-    uint8_t food_index = 0;
+    uint8_t food_index = FOOD_COUNT;
     for (uint8_t i = 0; i < FOOD_COUNT; i++) {
         if (!game->food[i].active) {
             food_index = i;
             break;
         }
     }
+    if (food_index == FOOD_COUNT) {
+        return;
+    }
     
-    // Clear the position first to ensure no invalid data
-    game->food[food_index].position.x = 255;
-    game->food[food_index].position.y = 255;
-    game->food[food_index].active = false;
-    
-    // Generate random position that's not in the snake
-    position_t new_pos;
-    uint8_t attempts = 0;
-    const uint8_t max_attempts = 200;  // Increased attempts
-    bool valid_pos_found = false;
+    snake_free_set_t *set = &game->free_set;
+    if (set->free_count == 0) {
+        ESP_LOGE(TAG, "Could not place food anywhere! Game area full?");
+        return;
+    }
     
-    // Exclude (0,0) from valid positions to prevent the top-left pixel issue
-    do {
-        new_pos.x = GAME_MIN_X + get_random_number(GAME_MAX_X - GAME_MIN_X + 1);
-        new_pos.y = GAME_MIN_Y + get_random_number(GAME_MAX_Y - GAME_MIN_Y + 1);
-        attempts++;
-        
-        // Additional check: avoid (0,0) position temporarily for debugging
-        if (new_pos.x == 0 && new_pos.y == 0) {
-            continue;  // Skip (0,0) position
-        }
-        
-        if (!is_position_in_snake(&game->snake, new_pos)) {
-            valid_pos_found = true;
-        }
-    } while (!valid_pos_found && attempts < max_attempts);
+    // Uniform pick from the free cells, no retries. (0,0) is never in the
+    // set, which avoids the top-left pixel issue.
+    uint16_t cell = set->free_cells[get_random_number(set->free_count)];
+    position_t new_pos = {cell % DISPLAY_WIDTH, cell / DISPLAY_WIDTH};
+    free_set_take(set, new_pos);
     
-    if (valid_pos_found) {
-        game->food[food_index].position = new_pos;
-        game->food[food_index].active = true;
-        ESP_LOGI(TAG, "Food generated at (%d, %d)", new_pos.x, new_pos.y);
-    } else {
-        // Fallback: place food at first available position (excluding 0,0)
-        ESP_LOGW(TAG, "Could not generate random food after %d attempts, using fallback", max_attempts);
-        bool found = false;
-        for (uint8_t y = GAME_MIN_Y; y <= GAME_MAX_Y && !found; y++) {
-            for (uint8_t x = GAME_MIN_X; x <= GAME_MAX_X && !found; x++) {
-                // Skip (0,0) position in fallback as well
-                if (x == 0 && y == 0) {
-                    continue;
-                }
-                
-                position_t test_pos = {x, y};
-                if (!is_position_in_snake(&game->snake, test_pos)) {
-                    game->food[food_index].position = test_pos;
-                    game->food[food_index].active = true;
-                    found = true;
-                    ESP_LOGI(TAG, "Fallback food generated at (%d, %d)", x, y);
-                }
-            }
-        }
-        
-        if (!found) {
-            ESP_LOGE(TAG, "Could not place food anywhere! Game area full?");
-            game->food[food_index].active = false;
-        }
-    }
+    game->food[food_index].position = new_pos;
+    game->food[food_index].active = true;
+    emit_change(game, new_pos, true);
+    TRACE(SNAKE_FOOD, TRACE_PACK(new_pos.x, new_pos.y), 0);
 }
 
 bool snake_game_check_collision(snake_game_t *game) {
-    position_t head = game->snake.segments[0];
+    position_t head = game->snake.segments[game->snake.head];
     
     // Check wall collision
     if (!is_valid_position(head)) {
-        ESP_LOGD(TAG, "Wall collision at (%d, %d)", head.x, head.y);
+        TRACE(SNAKE_COLLISION, 0, TRACE_PACK(head.x, head.y));
         return true;
     }
     
-    // Check self collision (skip head segment)
-    for (uint8_t i = 1; i < game->snake.length; i++) {
-        if (game->snake.segments[i].x == head.x && game->snake.segments[i].y == head.y) {
-            ESP_LOGD(TAG, "Self collision at (%d, %d)", head.x, head.y);
-            return true;
-        }
+    // Check self collision, the bitmap was tested before the head was added
+    if (game->snake.self_hit) {
+        TRACE(SNAKE_COLLISION, 1, TRACE_PACK(head.x, head.y));
+        return true;
     }
     
     return false;
 }
 
 bool snake_game_check_food_collision(snake_game_t *game) {
-    position_t head = game->snake.segments[0];
+    position_t head = game->snake.segments[game->snake.head];
     
     for (uint8_t i = 0; i < FOOD_COUNT; i++) {
         if (game->food[i].active &&
@@ -501,7 +630,7 @@ bool snake_game_check_food_collision(snake_game_t *game) {
             
             // Deactivate the eaten food
             game->food[i].active = false;
-            ESP_LOGD(TAG, "Food collision at (%d, %d)", head.x, head.y);
+            TRACE(SNAKE_COLLISION, 2, TRACE_PACK(head.x, head.y));
             return true;
         }
     }
@@ -512,12 +641,17 @@ bool snake_game_check_food_collision(snake_game_t *game) {
 void snake_game_demo(flip_dot_t *display, uint32_t duration_ms) {
     ESP_LOGI(TAG, "Starting Snake game demo");
     
-    snake_game_t game;
+    // Static, the full-board snake body is too big for the caller's stack
+    static snake_game_t game;
     snake_game_init(&game, display);
     snake_game_start(&game);
     
+    snake_clock_t game_clock;
+    if (snake_clock_init(&game_clock) != ESP_OK) {
+        return;
+    }
+    
     uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    uint32_t last_update = start_time;
     uint32_t direction_change_time = start_time;
     
     // Simple AI: change direction every few seconds
@@ -525,6 +659,10 @@ void snake_game_demo(flip_dot_t *display, uint32_t duration_ms) {
     uint8_t current_dir_index = 0;
     
     while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) < duration_ms) {
+        snake_clock_sync(&game_clock, true, game.game_speed_ms);
+        if (!(snake_clock_wait(&game_clock, portMAX_DELAY) & SNAKE_NOTIFY_TICK)) {
+            continue;
+        }
         uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
         
         // Change direction every 3 seconds for demo
@@ -534,22 +672,18 @@ void snake_game_demo(flip_dot_t *display, uint32_t duration_ms) {
             direction_change_time = current_time;
         }
         
-        // Update game at the appropriate speed
-        if (current_time - last_update >= game.game_speed_ms) {
-            snake_game_update(&game);
-            last_update = current_time;
-            
-            // Reset game if it's over
-            if (snake_game_is_over(&game)) {
-                snake_game_show_game_over(&game);
-                snake_game_reset(&game);
-                snake_game_start(&game);
-            }
-        }
+        snake_game_update(&game);
         
-        vTaskDelay(10 / portTICK_PERIOD_MS);  // Small delay to prevent busy waiting
+        // Reset game if it's over
+        if (snake_game_is_over(&game)) {
+            snake_clock_sync(&game_clock, false, 0);
+            snake_game_show_game_over(&game);
+            snake_game_reset(&game);
+            snake_game_start(&game);
+        }
     }
     
+    snake_clock_deinit(&game_clock);
     ESP_LOGI(TAG, "Snake game demo completed");
 }
 
@@ -561,18 +695,17 @@ void snake_game_demo(flip_dot_t *display, uint32_t duration_ms) {
 static snake_game_t *g_current_game = NULL;
 static input_system_t g_input_system;
 
-// Input callback function
+// Input callback function, called from input_system_process() in the game loop
 static void snake_input_callback(input_event_t *event) {
     if (!g_current_game || !event) {
         return;
     }
     
-    ESP_LOGI(TAG, "Input received: type=%d, cmd=%d, pressed=%d, game_state=%d", 
-             event->type, event->command, event->is_pressed, g_current_game->state);
+    TRACE(SNAKE_INPUT, TRACE_PACK(event->is_pressed, event->command), g_current_game->state);
     
     // Handle game start from any button press
     if (g_current_game->state == GAME_INIT) {
-        if (event->type == INPUT_TYPE_ESPNOW && event->is_pressed) {
+        if (event->is_pressed) {
             ESP_LOGI(TAG, "Starting game from button press");
             snake_game_start(g_current_game);
             return;
@@ -581,7 +714,6 @@ static void snake_input_callback(input_event_t *event) {
     
     // Only process direction changes if game is running
     if (g_current_game->state != GAME_RUNNING) {
-        ESP_LOGD(TAG, "Ignoring input - game not running (state=%d)", g_current_game->state);
         return;
     }
     
@@ -615,22 +747,21 @@ static void snake_input_callback(input_event_t *event) {
             return;  // Ignore other commands
     }
     
-    // Buffer the direction change
-    if (direction_buffer_push(&g_current_game->snake.input_buffer, new_direction)) {
-        ESP_LOGD(TAG, "Direction change buffered: %d", new_direction);
-    }
+    // Buffer the direction change, traced by the buffer
+    direction_buffer_push(&g_current_game->snake.input_buffer, new_direction);
 }
 
 void snake_game_run_interactive(flip_dot_t *display) {
-    snake_game_t game;
+    // Static, the full-board snake body is too big for the caller's stack
+    static snake_game_t game;
     snake_game_init(&game, display);
     g_current_game = &game;
     
     ESP_LOGI(TAG, "Game initialized with state: %d", game.state);
     
-    // Initialize input system with ESP-NOW enabled
+    // Controller over ESP-NOW and keys over the serial console, side by side
     input_system_config_t input_config = input_get_default_config();
-    input_config.enabled_types = INPUT_TYPE_ESPNOW;  // Only enable ESP-NOW
+    input_config.enabled_types = INPUT_TYPE_ESPNOW | INPUT_TYPE_SERIAL;
     input_config.callback = snake_input_callback;
     input_config.espnow_config = input_get_default_espnow_config();
     
@@ -660,22 +791,28 @@ void snake_game_run_interactive(flip_dot_t *display) {
     snake_game_render(&game);
     ESP_LOGI(TAG, "Start screen displayed, waiting for button press");
     
-    // Main game loop
-    uint32_t last_update = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    // Main game loop, sleeps until the next game tick or an input event
+    snake_clock_t game_clock;
+    if (snake_clock_init(&game_clock) != ESP_OK) {
+        return;
+    }
+    // Every input type notifies on receive, nothing needs polling
+    input_system_set_notify(&g_input_system, xTaskGetCurrentTaskHandle(), SNAKE_NOTIFY_INPUT);
     
     while (1) {
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        snake_clock_sync(&game_clock, game.state == GAME_RUNNING, game.game_speed_ms);
+        uint32_t events = snake_clock_wait(&game_clock, portMAX_DELAY);
         
         // Process input
         input_system_process(&g_input_system);
         
-        // Update game state at the appropriate speed
-        if (game.state == GAME_RUNNING && (current_time - last_update >= game.game_speed_ms)) {
+        // Update game state on the tick
+        if (game.state == GAME_RUNNING && (events & SNAKE_NOTIFY_TICK)) {
             snake_game_update(&game);
-            last_update = current_time;
             
             // Check for game over
             if (snake_game_is_over(&game)) {
+                snake_clock_sync(&game_clock, false, 0);
                 snake_game_show_game_over(&game);
                 vTaskDelay(2000 / portTICK_PERIOD_MS);  // Show game over for 2 seconds
                 snake_game_reset(&game);
@@ -693,7 +830,5 @@ void snake_game_run_interactive(flip_dot_t *display) {
                 ESP_LOGI(TAG, "Game reset, showing start screen");
             }
         }
-        
-        vTaskDelay(10 / portTICK_PERIOD_MS);  // Small delay to prevent busy waiting
     }
-} 
\ No newline at end of file
+}
@@ -18,10 +18,13 @@
  ******************************************************************************/
 
 // Game constants
-#define SNAKE_MAX_LENGTH 50
+#define SNAKE_MAX_LENGTH (DISPLAY_WIDTH * DISPLAY_HEIGHT)
 #define SNAKE_INITIAL_LENGTH 3
 #define FOOD_COUNT 1
 
+// Dots a tick can change: tail off, head on, grown tail and new food on
+#define SNAKE_MAX_TICK_CHANGES (3 + FOOD_COUNT)
+
 // Direction definitions
 typedef enum {
     DIR_UP,
@@ -54,10 +57,15 @@ typedef struct {
     uint8_t count; // Number of buffered directions
 } direction_buffer_t;
 
-// Snake segment structure
+// Snake segment structure. The body is a ring buffer that only moves its head
+// and tail index, plus an occupancy bitmap for constant time collision checks.
 typedef struct {
-    position_t segments[SNAKE_MAX_LENGTH];
-    uint8_t length;
+    position_t segments[SNAKE_MAX_LENGTH];  // Ring buffer, the head is at segments[head]
+    uint16_t head;
+    uint16_t length;
+    flip_dot_frame_t occupied;         // Cells covered by the body, bit x of row y
+    position_t last_tail;              // Tail cell vacated by the last move
+    bool self_hit;                     // Last move ran the head into the body
     snake_direction_t direction;
     direction_buffer_t input_buffer;  // Buffer for direction changes
 } snake_t;
@@ -68,16 +76,28 @@ typedef struct {
     bool active;
 } food_t;
 
+// Cells free for food, kept as an indexable set. free_cells[0..free_count)
+// holds cell indices y * DISPLAY_WIDTH + x, free_slot maps a cell back to its
+// slot or SNAKE_CELL_NONE, so add, remove and uniform pick are all O(1).
+typedef struct {
+    uint16_t free_cells[DISPLAY_PIXEL_COUNT];
+    uint16_t free_slot[DISPLAY_PIXEL_COUNT];
+    uint16_t free_count;
+} snake_free_set_t;
+
 // Game structure
 typedef struct {
     snake_t snake;
     food_t food[FOOD_COUNT];
+    snake_free_set_t free_set;
     game_state_t state;
     uint32_t score;
     uint32_t level;
     uint32_t game_speed_ms;
     flip_dot_t *display;
     uint8_t game_buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    flip_dot_change_t changes[SNAKE_MAX_TICK_CHANGES];  // Dots changed by the current tick
+    uint8_t change_count;
 } snake_game_t;
 
 /******************************************************************************
@@ -88,6 +108,10 @@ typedef struct {
 #define SNAKE_INITIAL_SPEED_MS 350
 #define SNAKE_SPEED_DECREASE_PER_LEVEL 50
 #define SNAKE_MIN_SPEED_MS 100
+#define SNAKE_GAME_OVER_TRANSITION_US 1500000
+
+// Free set slot of a cell that is taken
+#define SNAKE_CELL_NONE 0xFFFF
 
 // Display boundaries (full screen)
 #define GAME_MIN_X 0
@@ -0,0 +1,143 @@
+/**
+ * @file trace.c
+ * @brief Binary trace ring for hot-path events
+ *
+ * Dump format, one line each, read back by tools/trace_decode.py:
+ *   TRACE BEGIN <version> <cores> <cpu_mhz> <events>
+ *   TRACE <core> <record as 32 hex digits, in memory order>
+ *   TRACE END <records lost to ring wrap>
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+
+/******************************************************************************
+ * Private Definitions and Types
+ ******************************************************************************/
+
+static const char *TAG = "trace";
+
+#define TRACE_DUMP_VERSION 1
+
+#if CONFIG_FLIP_DOT_TRACE
+
+trace_ring_t trace_rings[portNUM_PROCESSORS];
+volatile bool trace_frozen;
+
+/******************************************************************************
+ * Private Function Declarations
+ ******************************************************************************/
+
+static void trace_dump_task(void *arg);
+
+/******************************************************************************
+ * Private Function Implementations
+ ******************************************************************************/
+
+static void trace_dump_task(void *arg) {
+    uart_port_t uart_num = CONFIG_ESP_CONSOLE_UART_NUM;
+    uint8_t c;
+    while (1) {
+        if (uart_read_bytes(uart_num, &c, 1, portMAX_DELAY) == 1) {
+            trace_dump_key_handler(c, NULL);
+        }
+    }
+}
+
+/******************************************************************************
+ * Public Function Implementations
+ ******************************************************************************/
+
+void trace_dump(void) {
+    trace_frozen = true;
+    // Let writers that already passed the check finish their record
+    vTaskDelay(1);
+
+    uint32_t lost = 0;
+    printf("TRACE BEGIN %d %d %ld %d\n", TRACE_DUMP_VERSION, portNUM_PROCESSORS,
+           esp_rom_get_cpu_ticks_per_us(), TRACE_EVENT_COUNT);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t *ring = &trace_rings[core];
+        uint32_t count = ring->head < CONFIG_FLIP_DOT_TRACE_RING_SIZE ? ring->head : CONFIG_FLIP_DOT_TRACE_RING_SIZE;
+        lost += ring->head - count;
+        for (uint32_t n = ring->head - count; n != ring->head; n++) {
+            const uint8_t *bytes = (const uint8_t *)&ring->records[n & (CONFIG_FLIP_DOT_TRACE_RING_SIZE - 1)];
+            printf("TRACE %d ", core);
+            for (size_t i = 0; i < sizeof(trace_record_t); i++) {
+                printf("%02x", bytes[i]);
+            }
+            printf("\n");
+        }
+    }
+    printf("TRACE END %ld\n", lost);
+    fflush(stdout);
+
+    trace_clear();
+    trace_frozen = false;
+}
+
+bool trace_dump_key_handler(uint8_t byte, void *ctx) {
+    if (byte != TRACE_DUMP_KEY) {
+        return false;
+    }
+    trace_dump();
+    return true;
+}
+
+void trace_clear(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_rings[core].head = 0;
+    }
+}
+
+esp_err_t trace_start_dump_task(void) {
+    uart_port_t uart_num = CONFIG_ESP_CONSOLE_UART_NUM;
+    if (uart_is_driver_installed(uart_num)) {
+        ESP_LOGE(TAG, "Console UART already has a reader, hook trace_dump_key_handler() into it");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = uart_driver_install(uart_num, 256, 0, 0, NULL, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install console UART driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(trace_dump_task, "trace_dump", TRACE_DUMP_TASK_STACK_SIZE,
+                                                 NULL, TRACE_DUMP_TASK_PRIORITY, NULL,
+                                                 CONFIG_FLIP_DOT_INPUT_TASK_CORE);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create trace dump task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Tracing %d records per core, send '%c' to dump", CONFIG_FLIP_DOT_TRACE_RING_SIZE, TRACE_DUMP_KEY);
+    return ESP_OK;
+}
+
+#else
+
+void trace_dump(void) {
+}
+
+void trace_clear(void) {
+}
+
+bool trace_dump_key_handler(uint8_t byte, void *ctx) {
+    return false;
+}
+
+esp_err_t trace_start_dump_task(void) {
+    ESP_LOGW(TAG, "Built without CONFIG_FLIP_DOT_TRACE");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_FLIP_DOT_TRACE */
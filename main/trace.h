@@ -0,0 +1,138 @@
+/**
+ * @file trace.h
+ * @brief Binary trace ring for hot-path events
+ *
+ * TRACE(event, a, b) stores a 16 byte record: the CPU cycle count, the
+ * event id and two 32-bit arguments, in a ring per core. Nothing is
+ * formatted on the device. trace_dump() writes the rings as hex lines over
+ * the console UART and tools/trace_decode.py turns them back into text,
+ * using the formats below.
+ *
+ * Built with CONFIG_FLIP_DOT_TRACE only. Without it TRACE() compiles to
+ * nothing and its arguments are not evaluated.
+ *
+ * @author Mikael Bengtsson
+ * @date 2026-10-14
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+/******************************************************************************
+ * Public Constants
+ ******************************************************************************/
+
+// Every event with its format. Formats are Python str.format strings over
+// the arguments a and b, a_hi/a_lo and b_hi/b_lo are their 16-bit halves.
+// Only ever append, the decoder numbers the events in this order.
+#define TRACE_EVENTS(X) \
+    X(FLIP_PIXEL,           "pixel ({a_hi},{a_lo}) = {b}") \
+    X(FLIP_PULSE_QUEUED,    "pulse queued, {a} us + {b} us recovery") \
+    X(FLIP_PULSE_FIRED,     "pulse fired, {a} us + {b} us recovery") \
+    X(FLIP_FRAME_OPEN,      "frame opened, {a} dots dirty") \
+    X(FLIP_FRAME_DONE,      "frame done, {a} flips in {b} us") \
+    X(FLIP_TIMING,          "supply {a} mV, pulse {b_hi} us, recovery {b_lo} us") \
+    X(FLIP_TRANSITION,      "transition {a_hi}, {a_lo} flips {b} us apart") \
+    X(DEMUX_4514,           "74HC4514 output {a}") \
+    X(DEMUX_139_ROW,        "74HC139 row output {a}, group {b}") \
+    X(DEMUX_139_COL,        "74HC139 col output {a}, group {b}") \
+    X(SNAKE_TICK,           "snake tick, head ({a_hi},{a_lo}), length {b}") \
+    X(SNAKE_DIR_BLOCKED,    "snake direction {b} blocked while going {a}") \
+    X(SNAKE_DIR_PUSH,       "snake direction {a} buffered, {b} queued") \
+    X(SNAKE_DIR_POP,        "snake direction {a} popped, {b} queued") \
+    X(SNAKE_COLLISION,      "snake collision {a} (0 wall, 1 self, 2 food) at ({b_hi},{b_lo})") \
+    X(SNAKE_GROW,           "snake grew to {a}, new tail ({b_hi},{b_lo})") \
+    X(SNAKE_FOOD,           "food placed at ({a_hi},{a_lo})") \
+    X(SNAKE_FOOD_DROPPED,   "food at ({a_hi},{a_lo}) dropped") \
+    X(SNAKE_RENDER,         "snake render, length {a}") \
+    X(SNAKE_INPUT,          "input cmd {a_lo} pressed {a_hi}, game state {b}")
+
+// Console key that makes the dump task write the rings
+#define TRACE_DUMP_KEY 'T'
+
+#define TRACE_DUMP_TASK_STACK_SIZE 3072
+#define TRACE_DUMP_TASK_PRIORITY 1
+
+/******************************************************************************
+ * Public Definitions and Types
+ ******************************************************************************/
+
+#define TRACE_EVENT_ID(name, format) TRACE_##name,
+typedef enum {
+    TRACE_EVENTS(TRACE_EVENT_ID)
+    TRACE_EVENT_COUNT
+} trace_event_t;
+#undef TRACE_EVENT_ID
+
+// Two 16-bit values in one argument, hi shows up as a_hi or b_hi
+#define TRACE_PACK(hi, lo) ((((uint32_t)(hi) & 0xFFFF) << 16) | ((uint32_t)(lo) & 0xFFFF))
+
+#if CONFIG_FLIP_DOT_TRACE
+
+#include "esp_cpu.h"
+
+_Static_assert((CONFIG_FLIP_DOT_TRACE_RING_SIZE & (CONFIG_FLIP_DOT_TRACE_RING_SIZE - 1)) == 0,
+               "The trace ring size must be a power of two");
+
+typedef struct {
+    uint32_t cycles;
+    uint16_t event;
+    uint16_t reserved;
+    uint32_t a;
+    uint32_t b;
+} trace_record_t;
+
+typedef struct {
+    uint32_t head;              // Records ever written, wraps the ring
+    trace_record_t records[CONFIG_FLIP_DOT_TRACE_RING_SIZE];
+} trace_ring_t;
+
+extern trace_ring_t trace_rings[];
+extern volatile bool trace_frozen;
+
+// A slot is claimed atomically, so an ISR on the same core cannot tear it
+static inline void trace_write(trace_event_t event, uint32_t a, uint32_t b) {
+    if (trace_frozen) {
+        return;
+    }
+    trace_ring_t *ring = &trace_rings[esp_cpu_get_core_id()];
+    uint32_t i = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & (CONFIG_FLIP_DOT_TRACE_RING_SIZE - 1);
+    trace_record_t *record = &ring->records[i];
+    record->cycles = esp_cpu_get_cycle_count();
+    record->event = event;
+    record->a = a;
+    record->b = b;
+}
+
+#define TRACE(event, a, b) trace_write(TRACE_##event, (uint32_t)(a), (uint32_t)(b))
+
+#else
+
+#define TRACE(event, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+
+#endif /* CONFIG_FLIP_DOT_TRACE */
+
+/******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+// Writes both rings, oldest record first, and empties them. Tracing pauses
+// while the dump runs.
+void trace_dump(void);
+void trace_clear(void);
+
+// Dumps the rings whenever TRACE_DUMP_KEY arrives on the console UART. Fails
+// when the UART already has a driver, its owner should pass bytes to
+// trace_dump_key_handler() instead.
+esp_err_t trace_start_dump_task(void);
+
+// Byte hook for whoever reads the console, e.g. input_serial_set_byte_handler().
+// Dumps and returns true on TRACE_DUMP_KEY.
+bool trace_dump_key_handler(uint8_t byte, void *ctx);
+
+#endif /* TRACE_H */
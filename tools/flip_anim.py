@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Encoder for pre-baked flip dot animations, see main/flip_anim.h for the format.
+
+Frames are written as text, one line per panel row with '#' or 'X' for a set
+dot and anything else for a clear one. Frames are separated by blank lines.
+A line '@ <ms>' sets the duration of the frames that follow it, '#!' starts a
+comment line.
+
+    #! two frame blink
+    @ 250
+    ############################
+    #..........................#
+    ...
+    (blank line)
+    ............................
+
+Usage:
+    flip_anim.py encode frames.txt anim.fda [--duration 100]
+    flip_anim.py info anim.fda [--show]
+
+Flash the result into the anim partition with
+    parttool.py write_partition --partition-name anim --input anim.fda
+"""
+
+import argparse
+import struct
+import sys
+
+WIDTH = 28
+HEIGHT = 13
+MAGIC = b"FDAN"
+VERSION = 1
+MAX_RUN = 16
+SHORT_SKIP_MAX = 6
+SKIP_EXTENDED = 7
+
+
+def parse_frames(text, default_ms):
+    frames = []
+    rows = []
+    duration = default_ms
+
+    def flush():
+        if not rows:
+            return
+        if len(rows) != HEIGHT:
+            raise ValueError("frame %d has %d rows, expected %d" % (len(frames), len(rows), HEIGHT))
+        frames.append((duration, [dot in "#X" for row in rows for dot in row.ljust(WIDTH)[:WIDTH]]))
+        rows.clear()
+
+    for line_no, line in enumerate(text.splitlines(), 1):
+        line = line.rstrip("\n")
+        if line.startswith("#!"):
+            continue
+        if line.startswith("@"):
+            flush()
+            duration = int(line[1:])
+            continue
+        if not line.strip():
+            flush()
+            continue
+        if len(line) > WIDTH:
+            raise ValueError("line %d is wider than %d dots" % (line_no, WIDTH))
+        rows.append(line)
+    flush()
+    return frames
+
+
+def leb128(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        out.append(byte | (0x80 if value else 0))
+        if not value:
+            return bytes(out)
+
+
+def encode_runs(dots, previous):
+    """Runs of dots whose value differs from previous, or all dots when previous is None."""
+    payload = bytearray()
+    cursor = 0
+    index = 0
+    while index < len(dots):
+        if previous is not None and dots[index] == previous[index]:
+            index += 1
+            continue
+        value = dots[index]
+        start = index
+        while (index < len(dots) and index - start < MAX_RUN and dots[index] == value
+               and (previous is None or dots[index] != previous[index])):
+            index += 1
+        skip = start - cursor
+        token = (0x80 if value else 0) | (index - start - 1)
+        if skip <= SHORT_SKIP_MAX:
+            payload.append(token | skip << 4)
+        else:
+            payload.append(token | SKIP_EXTENDED << 4)
+            payload += leb128(skip - SKIP_EXTENDED)
+        cursor = index
+    return bytes(payload)
+
+
+def encode(frames):
+    data = bytearray()
+    previous = None
+    for duration, dots in frames:
+        if not 0 <= duration <= 0xFFFF:
+            raise ValueError("duration %d ms out of range" % duration)
+        # The first frame is a keyframe, so looping needs no clear
+        payload = encode_runs(dots, previous)
+        data += struct.pack("<HH", duration, len(payload)) + payload
+        previous = dots
+    header = MAGIC + struct.pack("<BBBBII", VERSION, WIDTH, HEIGHT, 0, len(frames), len(data))
+    return header + bytes(data)
+
+
+def decode(blob):
+    if blob[:4] != MAGIC:
+        raise ValueError("not a flip dot animation")
+    version, width, height, _flags, frame_count, data_size = struct.unpack_from("<BBBBII", blob, 4)
+    if version != VERSION:
+        raise ValueError("unsupported version %d" % version)
+    dots = [False] * (width * height)
+    offset = 16
+    frames = []
+    for _ in range(frame_count):
+        duration, size = struct.unpack_from("<HH", blob, offset)
+        offset += 4
+        end = offset + size
+        cursor = 0
+        while offset < end:
+            token = blob[offset]
+            offset += 1
+            skip = (token >> 4) & 0x07
+            if skip == SKIP_EXTENDED:
+                shift = 0
+                while True:
+                    byte = blob[offset]
+                    offset += 1
+                    skip += (byte & 0x7F) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+            cursor += skip
+            run = (token & 0x0F) + 1
+            for i in range(cursor, cursor + run):
+                dots[i] = bool(token & 0x80)
+            cursor += run
+        frames.append((duration, list(dots)))
+    if offset != 16 + data_size:
+        raise ValueError("data size mismatch")
+    return width, height, frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flip dot animation encoder")
+    sub = parser.add_subparsers(dest="command", required=True)
+    enc = sub.add_parser("encode", help="encode text frames")
+    enc.add_argument("input")
+    enc.add_argument("output")
+    enc.add_argument("--duration", type=int, default=100, help="frame duration in ms before any '@' line")
+    info = sub.add_parser("info", help="decode and summarise an animation")
+    info.add_argument("input")
+    info.add_argument("--show", action="store_true", help="print every frame")
+    args = parser.parse_args()
+
+    if args.command == "encode":
+        with open(args.input) as f:
+            frames = parse_frames(f.read(), args.duration)
+        if not frames:
+            sys.exit("no frames in %s" % args.input)
+        blob = encode(frames)
+        if decode(blob)[2] != frames:
+            sys.exit("round trip failed")
+        with open(args.output, "wb") as f:
+            f.write(blob)
+        raw = len(frames) * (WIDTH * HEIGHT + 7) // 8
+        print("%d frames, %d bytes (%d raw)" % (len(frames), len(blob), raw))
+    else:
+        with open(args.input, "rb") as f:
+            blob = f.read()
+        width, height, frames = decode(blob)
+        total_ms = sum(duration for duration, _ in frames)
+        print("%dx%d, %d frames, %.1f s, %d bytes" % (width, height, len(frames), total_ms / 1000, len(blob)))
+        if args.show:
+            for i, (duration, dots) in enumerate(frames):
+                print("frame %d, %d ms" % (i, duration))
+                for r in range(height):
+                    print("".join("#" if d else "." for d in dots[r * width:(r + 1) * width]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Decoder for trace dumps, see main/trace.h and main/trace.c for the format.
+
+Reads a serial capture with one or more dumps, everything that is not a trace
+line is skipped, so a plain idf.py monitor log works. Events and their
+formats come straight from the TRACE_EVENTS list in trace.h, a record of an
+event the header does not know is printed raw.
+
+Each core is printed on its own, oldest record first, with the time since the
+first record on that core. The two cores' cycle counters are not in step, so
+times only compare within one core.
+
+Usage:
+    trace_decode.py capture.log [--header main/trace.h]
+    idf.py monitor | tee capture.log    # then press T
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<IHHII")
+DUMP_VERSION = 1
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "main", "trace.h")
+
+
+def load_events(path):
+    with open(path) as f:
+        text = f.read()
+    start = text.index("#define TRACE_EVENTS(X)")
+    end = text.index("\n\n", start)
+    return re.findall(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', text[start:end])
+
+
+def format_record(events, event, a, b):
+    if event >= len(events):
+        return "event %d a=0x%08x b=0x%08x" % (event, a, b)
+    name, fmt = events[event]
+    fields = {"a": a, "b": b, "a_hi": a >> 16, "a_lo": a & 0xFFFF, "b_hi": b >> 16, "b_lo": b & 0xFFFF}
+    return "%-20s %s" % (name, fmt.format(**fields))
+
+
+def decode(lines, events, out):
+    dump = 0
+    cores = {}
+    mhz = 1
+    for line in lines:
+        fields = line.split()
+        if len(fields) < 2 or "TRACE" not in fields:
+            continue
+        fields = fields[fields.index("TRACE"):]
+        if fields[1] == "BEGIN":
+            version, _, mhz, count = (int(v) for v in fields[2:6])
+            if version != DUMP_VERSION:
+                raise ValueError("dump version %d, expected %d" % (version, DUMP_VERSION))
+            if count != len(events):
+                print("warning: device has %d events, header %d" % (count, len(events)), file=sys.stderr)
+            dump += 1
+            cores = {}
+        elif fields[1] == "END":
+            print_dump(dump, cores, mhz, int(fields[2]), events, out)
+            cores = {}
+        elif len(fields) == 3 and fields[1].isdigit():
+            try:
+                record = RECORD.unpack(bytes.fromhex(fields[2]))
+            except ValueError:
+                continue
+            cores.setdefault(int(fields[1]), []).append(record)
+
+
+def print_dump(dump, cores, mhz, lost, events, out):
+    print("=== dump %d, %d records lost to ring wrap" % (dump, lost), file=out)
+    for core in sorted(cores):
+        print("--- core %d" % core, file=out)
+        elapsed = 0
+        last = None
+        for cycles, event, _, a, b in cores[core]:
+            # 32-bit counter, wraps every few seconds
+            if last is not None:
+                elapsed += (cycles - last) & 0xFFFFFFFF
+            last = cycles
+            print("%12.3f us  %s" % (elapsed / mhz, format_record(events, event, a, b)), file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="serial log, - for stdin")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="trace.h with the event list")
+    args = parser.parse_args()
+
+    events = load_events(args.header)
+    if args.capture == "-":
+        decode(sys.stdin, events, sys.stdout)
+    else:
+        with open(args.capture, errors="replace") as f:
+            decode(f, events, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()